@@ -0,0 +1,21 @@
+#version 330
+
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexColor;
+
+uniform mat4 mvp;
+uniform float animationTime;
+uniform float frameWidth;
+uniform float frameCount;
+
+out vec2 fragTexCoord;
+out vec4 fragColor;
+
+void main()
+{
+    float frame = mod(floor(animationTime + vertexColor.a*frameCount), frameCount);
+    fragTexCoord = vec2(vertexTexCoord.x + frame*frameWidth, vertexTexCoord.y);
+    fragColor = vec4(vertexColor.rgb, 1.0);
+    gl_Position = mvp*vec4(vertexPosition, 1.0);
+}
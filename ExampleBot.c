@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-space-invaders
+
+// Example bot: chases the nearest alien column, fires when lined up and
+// steps away from alien bullets about to land on it.
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include "SpaceInvadersBot.h"
+#include <math.h>
+
+//////////////////////////////////////////////////////////////////////
+// CONSTANTS
+//////////////////////////////////////////////////////////////////////
+
+static const float dodgeDistance = 24;
+static const unsigned int fireCooldownTicks = 8;
+
+//////////////////////////////////////////////////////////////////////
+// PROPERTIES
+//////////////////////////////////////////////////////////////////////
+
+static unsigned int lastFireTick;
+
+//////////////////////////////////////////////////////////////////////
+// FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+SPACE_INVADERS_BOT_EXPORT uint32_t SpaceInvadersBotAbiVersion(void)
+{
+    return SPACE_INVADERS_BOT_ABI_VERSION;
+}
+
+SPACE_INVADERS_BOT_EXPORT uint32_t SpaceInvadersBotUpdate(const SpaceInvadersBotView *view)
+{
+    if (view->gameState != SPACE_INVADERS_BOT_PLAY_STATE)
+        return view->tick % 2 == 0 ? SPACE_INVADERS_BOT_SHOOT | SPACE_INVADERS_BOT_SHOOT_HELD : 0;
+    if (!view->playerAlive)
+        return 0;
+    const float playerCenter = view->playerPosition.x + view->playerSize.x * 0.5f;
+    const float playerTop = view->playerPosition.y;
+    float targetX = playerCenter;
+    float nearestDistance = view->boundsSize.x;
+    for (uint32_t i = 0; i < view->alienExtent; ++i)
+    {
+        const float alienCenter = view->alienPositions[i].x + view->alienSize.x * 0.5f;
+        if (view->alienAlive[i] && fabsf(alienCenter - playerCenter) < nearestDistance)
+        {
+            nearestDistance = fabsf(alienCenter - playerCenter);
+            targetX = alienCenter;
+        }
+    }
+    for (uint32_t i = 0; i < view->alienBulletExtent; ++i)
+    {
+        const SpaceInvadersBotVector position = view->alienBulletPositions[i];
+        const float reach = view->playerSize.x * 0.5f + view->alienBulletRadii[i] + 1;
+        if (view->alienBulletAlive[i] && view->alienBulletVelocities[i].y > 0 && position.y < playerTop && position.y > playerTop - dodgeDistance && fabsf(position.x - playerCenter) < reach)
+            targetX = position.x < playerCenter ? position.x + reach * 2 : position.x - reach * 2;
+    }
+    uint32_t keys = 0;
+    if (targetX < playerCenter - view->playerSpeed * 0.5f)
+        keys |= SPACE_INVADERS_BOT_LEFT;
+    else if (targetX > playerCenter + view->playerSpeed * 0.5f)
+        keys |= SPACE_INVADERS_BOT_RIGHT;
+    if (keys == 0 && view->tick - lastFireTick >= fireCooldownTicks)
+    {
+        lastFireTick = view->tick;
+        keys |= SPACE_INVADERS_BOT_SHOOT | SPACE_INVADERS_BOT_SHOOT_HELD;
+    }
+    return keys;
+}
@@ -30,16 +30,98 @@
 // INCLUDES
 //////////////////////////////////////////////////////////////////////
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+#include "SpaceInvadersBot.h"
+#include <limits.h>
+#include <math.h>
+#include <signal.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+#include <io.h>
+__declspec(dllimport) int __stdcall QueryPerformanceCounter(long long *counter);
+__declspec(dllimport) int __stdcall QueryPerformanceFrequency(long long *frequency);
+#endif
 
 //////////////////////////////////////////////////////////////////////
 // DEFINES
 //////////////////////////////////////////////////////////////////////
 
+#define GAME_STATE_COUNT 5
 #define MAX_ALIEN_COUNT 128
-#define MAX_BULLET_COUNT 256
+#define ALIEN_TYPE_COUNT 4
+#define MAX_ALIEN_ROW_COUNT 5
+#define MAX_PLAYER_BULLET_COUNT 256
+#define MAX_ALIEN_BULLET_COUNT 4096
+#define MAX_EMITTER_COUNT 128
+#define BULLET_PATTERN_COUNT 4
+#define BULLET_OPCODE_COUNT 11
+#define MAX_BULLET_PATTERN_SIZE 64
+#define HOMING_GRID_COLUMNS 8
+#define HOMING_GRID_ROWS 5
+#define HOMING_GRID_CELL_COUNT 40
+#define MAX_DROP_COUNT 16
+#define POWER_UP_COUNT 4
+#define MAX_TIMER_COUNT 64
+#define TIMER_WHEEL_LEVEL_COUNT 3
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOT_COUNT 64
+#define MAX_UFO_COUNT 2
+#define UFO_PATTERN_COUNT 3
+#define UFO_PATH_COUNT 6
+#define UFO_WAYPOINT_COUNT 6
+#define UFO_PATH_SUBDIVISION_COUNT 32
+#define MAX_UFO_PATH_SAMPLE_COUNT 512
+#define MAX_BALANCE_WAVE_COUNT 64
+#define MAX_BALANCE_TICK_COUNT 14400
+#define MAX_BALANCE_JOB_COUNT 64
+#define MAX_STRESS_TICK_COUNT 36000
+#define MAX_STRESS_CORPUS_COUNT 16
+#define SOUND_EFFECT_COUNT 4
+#define MAX_VOICE_COUNT 64
+#define VOICE_QUEUE_SIZE 64
+#define MAX_STARTUP_PHASE_COUNT 16
+#define REPLAY_BLOCK_RUN_COUNT 128
+#define REPLAY_RUN_LENGTH_BITS 12
+#define ATTRACT_DEMO_COUNT 2
+#define HIGH_SCORE_COUNT 10
+#define HIGH_SCORE_QUEUE_SIZE 16
+#define MAX_PATH_LENGTH 512
+#define AUTOMATION_VALUE_COUNT 12
+#define CAPTURE_FRAME_COUNT 200
+#define CAPTURE_PALETTE_SIZE 256
+#define CAPTURE_LOOKUP_SIZE 32768
+#define CAPTURE_LZW_HASH_BITS 13
+#define CAPTURE_LZW_HASH_SIZE 8192
+#define READBACK_TARGET_COUNT 2
+#define SCREENSHOT_QUEUE_SIZE 4
+#define HANDLE_INDEX_BITS 16
+#define HANDLE_INDEX_MASK 0xFFFF
+#define ARCHETYPE_COUNT 7
+#define MAX_INSTANCE_COUNT 4
+#define INSTANCE_FIELD_COUNT (int)(sizeof(instanceFields) / sizeof(instanceFields[0]))
 
 //////////////////////////////////////////////////////////////////////
 // ENUMERATIONS
@@ -55,32 +137,413 @@ typedef enum GameState
 }
 GameState;
 
+_Static_assert(SPACE_INVADERS_BOT_PLAY_STATE == playState, "SpaceInvadersBot.h and GameState disagree on the play state");
+
+typedef enum InputFlag
+{
+    leftInput = 1,
+    rightInput = 2,
+    shootInput = 4,
+    shootHeldInput = 8,
+    allInputs = leftInput | rightInput | shootInput | shootHeldInput
+}
+InputFlag;
+
+_Static_assert(allInputs < 1 << (16 - REPLAY_RUN_LENGTH_BITS), "input flags must fit above the replay run length");
+
+typedef enum WaveShape
+{
+    squareShape,
+    sawtoothShape,
+    noiseShape
+}
+WaveShape;
+
+typedef enum SoundEffectId
+{
+    shootSoundEffect,
+    alienDeathSoundEffect,
+    playerDeathSoundEffect,
+    alienHitSoundEffect
+}
+SoundEffectId;
+
+typedef enum AlienTypeId
+{
+    basicAlienType,
+    gunnerAlienType,
+    armoredAlienType,
+    hunterAlienType
+}
+AlienTypeId;
+
+typedef enum BulletPatternId
+{
+    singleBulletPattern,
+    spreadBulletPattern,
+    aimedWaveBulletPattern,
+    homingBulletPattern
+}
+BulletPatternId;
+
+typedef enum BulletOpcode
+{
+    haltOpcode,
+    speedOpcode,
+    angleOpcode,
+    aimOpcode,
+    waveOpcode,
+    fireOpcode,
+    spreadOpcode,
+    waitOpcode,
+    repeatOpcode,
+    endOpcode,
+    homeOpcode
+}
+BulletOpcode;
+
+typedef enum PowerUpId
+{
+    rapidFirePowerUp,
+    multiShotPowerUp,
+    shieldPowerUp,
+    slowTimePowerUp
+}
+PowerUpId;
+
+typedef enum TimerEvent
+{
+    readyTimerEvent,
+    winTimerEvent,
+    loseTimerEvent,
+    ufoTimerEvent,
+    dropTimerEvent,
+    powerUpTimerEvent,
+    reloadTimerEvent,
+    flashTimerEvent
+}
+TimerEvent;
+
+typedef enum AutomationCommand
+{
+    pauseCommand,
+    resumeCommand,
+    stepCommand,
+    inputCommand,
+    seedCommand,
+    waveCommand,
+    stateCommand,
+    countersCommand
+}
+AutomationCommand;
+
+typedef enum ArchetypeId
+{
+    playerArchetype,
+    alienArchetype,
+    playerBulletArchetype,
+    alienBulletArchetype,
+    ufoArchetype,
+    emitterArchetype,
+    dropArchetype
+}
+ArchetypeId;
+
+typedef enum ComponentFlag
+{
+    positionComponent = 1,
+    velocityComponent = 2,
+    spriteComponent = 4,
+    circleComponent = 8,
+    ownerComponent = 16,
+    boundedComponent = 32,
+    pathComponent = 64,
+    oscillatorComponent = 128
+}
+ComponentFlag;
+
 //////////////////////////////////////////////////////////////////////
 // STRUCTURES
 //////////////////////////////////////////////////////////////////////
 
-typedef struct Player
+typedef unsigned int EntityHandle;
+
+typedef struct Archetype
+{
+    unsigned int components;
+    int capacity;
+    int *nextAvailable;
+    int *extent;
+    bool *alive;
+    unsigned short *generations;
+    Vector2 *positions;
+    Vector2 *velocities;
+    float *radii;
+    Color *colors;
+    EntityHandle *owners;
+    const Texture2D *texture;
+    unsigned char *phases;
+    int frameCount;
+    unsigned char *types;
+    int typeCount;
+    unsigned char *paths;
+    int *pathTicks;
+    Vector2 *anchors;
+    Vector2 *drifts;
+    Vector2 *springs;
+}
+Archetype;
+
+typedef struct AlienType
+{
+    unsigned char hitPoints;
+    unsigned char fireRate;
+    unsigned char score;
+    unsigned char pattern;
+}
+AlienType;
+
+typedef struct BulletEmitter
+{
+    unsigned char pattern;
+    unsigned char programCounter;
+    unsigned char waitTicks;
+    unsigned char repeatStart;
+    unsigned char repeatCount;
+    unsigned char waveAmplitude;
+    unsigned char wavePeriod;
+    unsigned char homing;
+    float angle;
+    float speed;
+}
+BulletEmitter;
+
+typedef struct PowerUp
+{
+    const char *name;
+    Color color;
+    float seconds;
+}
+PowerUp;
+
+typedef struct Timer
+{
+    unsigned int expiry;
+    unsigned short generation;
+    unsigned char event;
+    unsigned char payload;
+    short slot;
+    short previous;
+    short next;
+    EntityHandle argument;
+}
+Timer;
+
+typedef struct InstanceField
+{
+    void *data;
+    int size;
+    int stride;
+    const int *extent;
+}
+InstanceField;
+
+typedef struct GameStateDescriptor
+{
+    void (*enter)();
+    void (*exit)();
+    void (*update)();
+    void (*draw)();
+    void (*preload)();
+    GameState nextState;
+}
+GameStateDescriptor;
+
+typedef struct WaveText
+{
+    int wave;
+    char readyText[24];
+    int readyHalfWidth;
+    char completeText[24];
+    int completeHalfWidth;
+    char shelfText[16];
+    int shelfWidth;
+}
+WaveText;
+
+typedef struct ReferenceAlien
 {
     Vector2 position;
-    int livesRemaining;
     bool alive;
 }
-Player;
+ReferenceAlien;
 
-typedef struct Bullet
+typedef struct ReferenceBullet
 {
     Vector2 position;
     bool belongsToPlayer;
     bool active;
 }
-Bullet;
+ReferenceBullet;
 
-typedef struct Alien
+typedef struct SoundEffect
 {
-    Vector2 position;
-    bool alive;
+    unsigned char shape;
+    unsigned char dutyCycle;
+    unsigned short startFrequency;
+    unsigned short endFrequency;
+    unsigned char attack;
+    unsigned char sustain;
+    unsigned char decay;
+    unsigned char volume;
+}
+SoundEffect;
+
+typedef struct Voice
+{
+    const float *samples;
+    int frameCount;
+    int position;
+    float leftGain;
+    float rightGain;
+}
+Voice;
+
+typedef struct VoiceCommand
+{
+    int effect;
+    float leftGain;
+    float rightGain;
+}
+VoiceCommand;
+
+typedef struct ReplayHeader
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int tickCount;
+    unsigned int blockCount;
+    unsigned int keyframeCount;
+    unsigned int blockIndexOffset;
+    unsigned int keyframeIndexOffset;
+    unsigned int stateSize;
+}
+ReplayHeader;
+
+typedef struct ReplayBlock
+{
+    unsigned int firstTick;
+    unsigned short runs[REPLAY_BLOCK_RUN_COUNT];
+}
+ReplayBlock;
+
+typedef struct ReplayIndexEntry
+{
+    unsigned int tick;
+    unsigned int offset;
+    unsigned int size;
+}
+ReplayIndexEntry;
+
+typedef struct AttractDemo
+{
+    unsigned int seed;
+    int startWave;
+    int runCount;
+    const unsigned short *runs;
+}
+AttractDemo;
+
+typedef struct AutomationRequest
+{
+    unsigned int command;
+    unsigned int argument;
+}
+AutomationRequest;
+
+typedef struct AutomationReply
+{
+    unsigned int command;
+    unsigned int accepted;
+    unsigned int values[AUTOMATION_VALUE_COUNT];
+}
+AutomationReply;
+
+typedef struct HighScoreRecord
+{
+    unsigned int magic;
+    unsigned int score;
+    unsigned int wave;
+    unsigned int timestamp;
+    unsigned int checksum;
+}
+HighScoreRecord;
+
+typedef struct GifBitWriter
+{
+    FILE *file;
+    unsigned int bits;
+    int bitCount;
+    unsigned char block[255];
+    int blockSize;
+}
+GifBitWriter;
+
+typedef struct ReadbackTargets
+{
+    RenderTexture2D targets[READBACK_TARGET_COUNT];
+    bool pending[READBACK_TARGET_COUNT];
+    int next;
+}
+ReadbackTargets;
+
+typedef struct ScreenshotJob
+{
+    Image image;
+    char path[48];
+}
+ScreenshotJob;
+
+typedef struct StartupPhase
+{
+    char name[48];
+    double seconds;
+}
+StartupPhase;
+
+typedef struct ScriptedPlayer
+{
+    int reactionTicks;
+    int fireCooldownTicks;
+    int aimError;
+    int dodgeDistance;
+    int targetX;
+    int reactionElapsed;
+    int fireElapsed;
 }
-Alien;
+ScriptedPlayer;
+
+typedef struct BalanceWaveResult
+{
+    unsigned int trialCount;
+    unsigned int clearCount;
+    unsigned int timeoutCount;
+    unsigned int clearTicks[MAX_BALANCE_TICK_COUNT];
+}
+BalanceWaveResult;
+
+typedef struct StressCase
+{
+    unsigned int seed;
+    int startWave;
+    int tickCount;
+    double cost;
+    int worstTick;
+    int worstWorkload;
+    unsigned int inputHash;
+    unsigned char inputs[MAX_STRESS_TICK_COUNT];
+}
+StressCase;
 
 //////////////////////////////////////////////////////////////////////
 // CONSTANTS
@@ -103,14 +566,171 @@ static const int playerBulletRadius = 3;
 static const int alienBulletRadius = 2;
 static const Color playerBulletColor = GOLD;
 static const Color alienBulletColor = PURPLE;
+static const Color playerMissileColor = SKYBLUE;
 static const int playerSpeed = 3;
 static const float alienSpeed = 0.5;
+static const int alienStepDown = 4;
 static const int playerBulletSpeed = 2;
 static const int alienBulletSpeed = 1;
 static const int textSize = 20;
 static const float delayThreshold = 3;
 static const float animationThreshold = 0.5;
-static const int animationFrameCount = 2;
+static const float hitFlashDuration = 0.1f;
+static const float tickTime = 1.0f / 60;
+static const int ufoWidth = 16;
+static const int ufoHeight = 7;
+static const float ufoSpeed = 1;
+static const int ufoMinSpawnSeconds = 15;
+static const int ufoMaxSpawnSeconds = 30;
+static const AlienType alienTypes[ALIEN_TYPE_COUNT] = {
+    { 1, 100, 10, singleBulletPattern },
+    { 1, 35, 20, spreadBulletPattern },
+    { 2, 25, 30, aimedWaveBulletPattern },
+    { 1, 40, 40, homingBulletPattern }
+};
+static const char *bulletPatternSources[BULLET_PATTERN_COUNT] = {
+    "fire",
+    "spread 3 15",
+    "speed 8 aim wave 6 40 repeat 3 fire wait 12 end",
+    "speed 7 home 4 fire"
+};
+static const char *bulletOpcodeNames[BULLET_OPCODE_COUNT] = { "halt", "speed", "angle", "aim", "wave", "fire", "spread", "wait", "repeat", "end", "home" };
+static const unsigned char bulletOpcodeOperandCounts[BULLET_OPCODE_COUNT] = { 0, 1, 1, 0, 2, 0, 2, 1, 1, 0, 1 };
+static const unsigned char alienRowTypes[MAX_ALIEN_ROW_COUNT] = { basicAlienType, gunnerAlienType, armoredAlienType, gunnerAlienType, hunterAlienType };
+static const int ufoScores[4] = { 50, 100, 150, 300 };
+static const int ufoMissileReward = 5;
+static const float playerMissileHoming = 0.15f;
+static const int homingCellSize = 32;
+static const PowerUp powerUps[POWER_UP_COUNT] = {
+    { "Rapid Fire", RED, 8 },
+    { "Multi-Shot", LIME, 8 },
+    { "Shield", BLUE, 6 },
+    { "Slow Time", BEIGE, 5 }
+};
+static const int dropRadius = 3;
+static const float dropSpeed = 0.5f;
+static const float dropLifetime = 6;
+static const int dropOdds = 10;
+static const int rapidFireTicks = 8;
+static const int multiShotCount = 3;
+static const float multiShotSpread = 0.5f;
+static const Color shieldColor = BLUE;
+static const Vector2 ufoWaypoints[UFO_PATTERN_COUNT][UFO_WAYPOINT_COUNT] = {
+    { { -16, 6 }, { 35, 6 }, { 86, 6 }, { 138, 6 }, { 189, 6 }, { 240, 6 } },
+    { { -16, 8 }, { 32, 14 }, { 80, 2 }, { 128, 14 }, { 176, 2 }, { 240, 8 } },
+    { { -16, 2 }, { 40, 2 }, { 96, 12 }, { 128, 12 }, { 184, 2 }, { 240, 2 } }
+};
+static const EntityHandle nullHandle = 0;
+static const int soundEffectSampleRate = 22050;
+static const float soundEffectStepTime = 0.01f;
+static const SoundEffect soundEffects[SOUND_EFFECT_COUNT] = {
+    { squareShape, 128, 880, 220, 0, 4, 16, 96 },
+    { noiseShape, 128, 2400, 300, 0, 6, 44, 128 },
+    { noiseShape, 128, 900, 60, 1, 12, 52, 160 },
+    { squareShape, 64, 1400, 1800, 0, 2, 6, 80 }
+};
+static const char *soundEffectNames[SOUND_EFFECT_COUNT] = { "Shoot", "AlienDeath", "PlayerDeath", "AlienHit" };
+static const int instanceKeys[MAX_INSTANCE_COUNT][3] = {
+    { KEY_A, KEY_D, KEY_ENTER },
+    { KEY_LEFT, KEY_RIGHT, KEY_RIGHT_CONTROL },
+    { KEY_J, KEY_L, KEY_I },
+    { KEY_KP_4, KEY_KP_6, KEY_KP_8 }
+};
+static const Color viewportBorderColor = DARKGRAY;
+static const float maxFrameTime = 0.25f;
+static const unsigned int replayMagic = 0x50524953;
+static const unsigned int replayVersion = 3;
+static const int replayMaxRunLength = (1 << REPLAY_RUN_LENGTH_BITS) - 1;
+static const int replayKeyframeTicks = 3600;
+static const float attractDelay = 10;
+static const int attractFPS = 30;
+static const int attractMaxTicks = 1800;
+static const unsigned short attractDemoRuns0[] = {
+    0x00B9, 0x1002, 0x0004, 0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xE001,
+    0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xC001, 0x0005, 0x1001, 0x0005, 0xC001,
+    0x0005, 0x2006, 0xD001, 0x1001, 0x2001, 0x1001, 0x2001, 0x1002, 0x2001, 0x1004, 0x000E, 0x2004,
+    0xC001, 0x0005, 0x1001, 0x0005, 0xD001, 0x0005, 0x1001, 0x0001, 0x1001, 0x2001, 0x1001, 0x2001,
+    0xD001, 0x0005, 0x1001, 0x0005, 0xD001, 0x0005, 0x1001, 0x0005, 0xD001, 0x0005, 0x1001, 0x0005,
+    0xD001, 0x0005, 0x1001, 0x0005, 0xD001, 0x000F, 0x2001, 0xE001, 0x200E, 0xE001, 0x0003, 0x2001,
+    0x0005, 0x2001, 0x0001, 0xC001, 0x0003, 0x2001, 0x0005, 0x2001, 0x0001, 0xC001, 0x0003, 0x2001,
+    0x0005, 0x2001, 0x0001, 0xC001, 0x0003, 0x2001, 0x0005, 0x2001, 0x0001, 0xC001, 0x0003, 0x2001,
+    0x0005, 0x2001, 0x0001, 0xC001, 0x0003, 0x2001, 0x0005, 0x2001, 0x0001, 0xC001, 0x0003, 0x2001,
+    0x0005, 0x2001, 0x0001, 0xC001, 0x0003, 0x2001, 0x0005, 0x2001, 0x0001, 0xC001, 0x0003, 0x2001,
+    0x0005, 0x1001, 0x0001, 0xC001, 0x0003, 0x1001, 0x0005, 0x1001, 0x0001, 0xC001, 0x0003, 0x2003,
+    0x0003, 0x1001, 0x0001, 0xC001, 0x0003, 0x2003, 0x0003, 0x1001, 0x0001, 0xC001, 0x0003, 0x1034,
+    0xD001, 0x0001, 0x1001, 0x0009, 0xC001, 0x000E, 0x1003, 0xD001, 0x0007, 0x2001, 0x0003, 0xC001,
+    0x0001, 0x2001, 0x0005, 0x1003, 0x0001, 0xC001, 0x0001, 0x2001, 0x0005, 0x2001, 0x0003, 0xC001,
+    0x0001, 0x1003, 0x0003, 0x2001, 0x0003, 0xC001, 0x0001, 0x1003, 0x0003, 0x2001, 0x0169, 0x1005,
+    0xD001, 0x0004, 0x2001, 0x0005, 0x2001, 0xC001, 0x0004, 0x2001, 0x0005, 0x2001, 0xC001, 0x0004,
+    0x2001, 0x0005, 0x2001, 0xC001, 0x0004, 0x2001, 0x0005, 0x2001, 0xC001, 0x000A, 0x1001, 0xC001,
+    0x0004, 0x1001, 0x0005, 0x1001, 0xC001, 0x000E, 0x2001, 0xE001, 0x2003, 0x0003, 0x1001, 0x0004,
+    0xC001, 0x2003, 0x0003, 0x1001, 0x0004, 0xC001, 0x1001, 0x0005, 0x1001, 0x0004, 0xC001, 0x1001,
+    0x0011, 0x2004, 0xE001, 0x0001, 0x1002, 0x2001, 0x1001, 0x2001, 0x1001, 0x2004, 0xC001, 0x000D,
+    0xE001, 0x0005, 0x1001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005,
+    0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005,
+    0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005,
+    0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005,
+    0xD001, 0x0005, 0x1001, 0x0005, 0x2002, 0xE001, 0x0003, 0x1001, 0x0005, 0x2002, 0xE001, 0x0003,
+    0x1001, 0x0005, 0x1039, 0xD001, 0x0002, 0x1001, 0x0005, 0x1001, 0x0002, 0xC001, 0x0002, 0x1001,
+    0x0005, 0x1001, 0x0002, 0xC001, 0x0002, 0x1001, 0x0005, 0x1001, 0x0002, 0xC001, 0x0002, 0x2001,
+    0x0005, 0x1003, 0xC001, 0x0002, 0x2001, 0x0005, 0x1003, 0xC001, 0x0002, 0x2001, 0x0114
+};
+static const unsigned short attractDemoRuns1[] = {
+    0x00B9, 0x1002, 0x0004, 0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xE001,
+    0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xC001, 0x0011, 0xE001, 0x0005, 0x1001,
+    0x0005, 0xD001, 0x0005, 0x1001, 0x0005, 0xC001, 0x0010, 0x1003, 0xD001, 0x0003, 0x1001, 0x0005,
+    0x1001, 0x0001, 0xC001, 0x0003, 0x1001, 0x0005, 0x1001, 0x0001, 0xC001, 0x0003, 0x1001, 0x0005,
+    0x1001, 0x0001, 0xC001, 0x0013, 0x1003, 0xD001, 0x0004, 0x1001, 0x0006, 0xC001, 0x0001, 0x2001,
+    0x0002, 0x2001, 0x0005, 0x2001, 0xC001, 0x0004, 0x2001, 0x0005, 0x2001, 0xC001, 0x0004, 0x2001,
+    0x0005, 0x2001, 0xC001, 0x0004, 0x2001, 0x0005, 0x2001, 0xC001, 0x0004, 0x2001, 0x0005, 0x2001,
+    0xC001, 0x0004, 0x2001, 0x0005, 0x2001, 0xE001, 0x2004, 0x0012, 0xC001, 0x000B, 0xC001, 0x0016,
+    0x2001, 0x0001, 0x2001, 0xC001, 0x2001, 0x0008, 0x2001, 0x0001, 0xC001, 0x0003, 0x1001, 0x0007,
+    0xC001, 0x0003, 0x1001, 0x0007, 0xC001, 0x0003, 0x1001, 0x0005, 0x200A, 0xE001, 0x000B, 0xC001,
+    0x000D, 0x2001, 0xE001, 0x0005, 0x1001, 0x0005, 0xC001, 0x0004, 0x1001, 0x0006, 0xC001, 0x0004,
+    0x1001, 0x0006, 0xC001, 0x0004, 0x1001, 0x0006, 0xC001, 0x0004, 0x1001, 0x0006, 0xC001, 0x0004,
+    0x1001, 0x0006, 0xC001, 0x000B, 0xC001, 0x0010, 0xC001, 0x000B, 0xC001, 0x000B, 0xD001, 0x000B,
+    0xD001, 0x000B, 0xD001, 0x000B, 0xD001, 0x000B, 0xD001, 0x000B, 0xD001, 0x0004, 0x1002, 0x0005,
+    0xC001, 0x0011, 0xC001, 0x000B, 0x2013, 0xE001, 0x0004, 0x2001, 0x0005, 0x2001, 0xC001, 0x0004,
+    0x2001, 0x0005, 0x2001, 0xC001, 0x0004, 0x2001, 0x0005, 0x2001, 0xC001, 0x0004, 0x2001, 0x0005,
+    0x2001, 0xC001, 0x0004, 0x2001, 0x0005, 0x2001, 0xC001, 0x0004, 0x2001, 0x0005, 0x2001, 0xC001,
+    0x0004, 0x1001, 0x0005, 0x1001, 0xC001, 0x0004, 0x100F, 0x0003, 0x1021, 0xD001, 0x0002, 0x1001,
+    0x0005, 0x1001, 0x0002, 0xC001, 0x1002, 0x0009, 0xC001, 0x0002, 0x1001, 0x0005, 0x1001, 0x0002,
+    0xC001, 0x0002, 0x1001, 0x0005, 0x1001, 0x0002, 0xC001, 0x0002, 0x1001, 0x0005, 0x1001, 0x0001,
+    0x2001, 0xC001, 0x000B, 0xC001, 0x0002, 0x2001, 0x000E, 0x1001, 0xD001, 0x0001, 0x2001, 0x0005,
+    0x2001, 0x0003, 0xC001, 0x000A, 0x1001, 0xD001, 0x0001, 0x2001, 0x0005, 0x2001, 0x0003, 0xC001,
+    0x0001, 0x2001, 0x0005, 0x1003, 0x0001, 0xC001, 0x0001, 0x2001, 0x0005, 0x2001, 0x0003, 0xC001,
+    0x0001, 0x2001, 0x0005, 0x1003, 0x0001, 0xC001, 0x0001, 0x2001, 0x0005, 0x2001, 0x0003, 0xC001,
+    0x0001, 0x2001, 0x016A, 0x1003, 0x2001, 0x0003, 0xC001, 0x0001, 0x2001, 0x0005, 0x2001, 0x0003,
+    0xC001, 0x0001, 0x2001, 0x0005, 0x2001, 0x0003, 0xC001, 0x0001, 0x2001, 0x0005, 0x2001, 0x0003,
+    0xC001, 0x0001, 0x2001, 0x0005, 0x2001, 0x0003, 0xC001, 0x0001, 0x2001, 0x0009, 0xC001, 0x0001,
+    0x2002, 0x0004, 0x1001, 0x0003, 0xC001, 0x0001, 0x1001, 0x0005, 0x1001, 0x0003, 0xC001, 0x0001,
+    0x1001, 0x0005, 0x1001, 0x0003, 0xC001, 0x0001, 0x1001, 0x0005, 0x1001, 0x0003, 0xC001, 0x0001,
+    0x1001, 0x0005, 0x1001, 0x0003, 0xC001, 0x0001, 0x1001, 0x0005, 0x1001, 0x0003, 0xC001, 0x0001,
+    0x1001, 0x0005, 0x1001, 0x0003, 0xC001, 0x0001, 0x1001, 0x0005, 0x1001, 0x0003, 0xC001, 0x0001,
+    0x1001, 0x0005, 0x1001, 0x0003, 0xC001, 0x0001, 0x1001, 0x0009, 0xC001, 0x0002, 0x1001, 0x0008,
+    0xC001, 0x000B, 0xC001, 0x000E, 0x1001, 0xD001, 0x0003, 0x2001, 0x0005, 0x1006, 0xC001, 0x0005,
+    0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xE001, 0x0005, 0x2001, 0x0005, 0xC001, 0x0006
+};
+static const AttractDemo attractDemos[ATTRACT_DEMO_COUNT] = {
+    { 7, 1, sizeof(attractDemoRuns0) / sizeof(attractDemoRuns0[0]), attractDemoRuns0 },
+    { 11, 4, sizeof(attractDemoRuns1) / sizeof(attractDemoRuns1[0]), attractDemoRuns1 }
+};
+static const char *highScoreLogName = "HighScores.log";
+static const char *highScoreCompactName = "HighScores.log.tmp";
+static const unsigned int highScoreMagic = 0x53484953;
+static const unsigned int highScoreChecksumSalt = 10;
+static const int highScoreCompactThreshold = 64;
+static const int highScoreDisplayCount = 5;
+static const int automationBacklog = 1;
+static const unsigned int automationStepTicksPerFrame = 600;
+static const unsigned int defaultBotBudgetNanoseconds = 250000;
+static const int captureWidth = 240;
+static const int captureHeight = 135;
+static const int captureFrameRate = 20;
+static const int gifMinimumCodeSize = 8;
+static const int gifMaxCode = 4095;
+static const int mixerBufferFrames = 512;
+static const int musicStreamBufferFrames = 4096;
 
 //////////////////////////////////////////////////////////////////////
 // LOADED PROPERTIES
@@ -118,10 +738,20 @@ static const int animationFrameCount = 2;
 
 static Texture2D playerTexture;
 static Texture2D alienTexture;
+static Texture2D ufoTexture;
+static Shader alienShader;
+static int alienShaderTimeLocation;
+static int alienShaderFrameWidthLocation;
+static int alienShaderFrameCountLocation;
+
+static Vector2 ufoPathPoints[UFO_PATH_COUNT][MAX_UFO_PATH_SAMPLE_COUNT];
+static int ufoPathSampleCounts[UFO_PATH_COUNT];
+
+static unsigned char bulletPatternCode[BULLET_PATTERN_COUNT][MAX_BULLET_PATTERN_SIZE];
 
-static Sound shootSound;
-static Sound playerDeathSound;
-static Sound alienDeathSound;
+static float *soundEffectSamples[SOUND_EFFECT_COUNT];
+static int soundEffectFrameCounts[SOUND_EFFECT_COUNT];
+static AudioStream mixerStream;
 
 static Music music;
 
@@ -130,22 +760,324 @@ static Music music;
 //////////////////////////////////////////////////////////////////////
 
 static GameState gameState;
-static Player player;
+static bool playerAlive[1];
+static int playerExtent = 1;
+static unsigned short playerGenerations[1];
+static Vector2 playerPositions[1];
+static int livesRemaining;
 static Camera2D camera;
 static Rectangle cameraBounds;
-static Alien aliens[MAX_ALIEN_COUNT];
+static bool alienAlive[MAX_ALIEN_COUNT];
+static unsigned short alienGenerations[MAX_ALIEN_COUNT];
+static Vector2 alienPositions[MAX_ALIEN_COUNT];
+static Vector2 alienVelocities[MAX_ALIEN_COUNT];
+static unsigned char alienTypeIds[MAX_ALIEN_COUNT];
+static unsigned char alienHitPoints[MAX_ALIEN_COUNT];
+static bool alienHitFlashes[MAX_ALIEN_COUNT];
+static int nextAvailablePlayer;
+static unsigned char alienPhases[MAX_ALIEN_COUNT];
 static int nextAvailableAlien;
-static Bullet bullets[MAX_BULLET_COUNT];
-static int nextAvailableBullet;
+static int alienExtent;
+static bool playerBulletAlive[MAX_PLAYER_BULLET_COUNT];
+static unsigned short playerBulletGenerations[MAX_PLAYER_BULLET_COUNT];
+static Vector2 playerBulletPositions[MAX_PLAYER_BULLET_COUNT];
+static Vector2 playerBulletVelocities[MAX_PLAYER_BULLET_COUNT];
+static float playerBulletHomingRates[MAX_PLAYER_BULLET_COUNT];
+static float playerBulletRadii[MAX_PLAYER_BULLET_COUNT];
+static Color playerBulletColors[MAX_PLAYER_BULLET_COUNT];
+static int nextAvailablePlayerBullet;
+static int playerBulletExtent;
+static bool alienBulletAlive[MAX_ALIEN_BULLET_COUNT];
+static unsigned short alienBulletGenerations[MAX_ALIEN_BULLET_COUNT];
+static Vector2 alienBulletPositions[MAX_ALIEN_BULLET_COUNT];
+static Vector2 alienBulletVelocities[MAX_ALIEN_BULLET_COUNT];
+static Vector2 alienBulletAnchors[MAX_ALIEN_BULLET_COUNT];
+static Vector2 alienBulletDrifts[MAX_ALIEN_BULLET_COUNT];
+static Vector2 alienBulletSprings[MAX_ALIEN_BULLET_COUNT];
+static float alienBulletHomingRates[MAX_ALIEN_BULLET_COUNT];
+static float alienBulletRadii[MAX_ALIEN_BULLET_COUNT];
+static Color alienBulletColors[MAX_ALIEN_BULLET_COUNT];
+static EntityHandle alienBulletOwners[MAX_ALIEN_BULLET_COUNT];
+static int nextAvailableAlienBullet;
+static int alienBulletExtent;
+static bool ufoAlive[MAX_UFO_COUNT];
+static unsigned short ufoGenerations[MAX_UFO_COUNT];
+static Vector2 ufoPositions[MAX_UFO_COUNT];
+static unsigned char ufoPaths[MAX_UFO_COUNT];
+static int ufoPathTicks[MAX_UFO_COUNT];
+static int nextAvailableUfo;
+static int ufoExtent;
+static bool emitterAlive[MAX_EMITTER_COUNT];
+static unsigned short emitterGenerations[MAX_EMITTER_COUNT];
+static EntityHandle emitterOwners[MAX_EMITTER_COUNT];
+static BulletEmitter emitterStates[MAX_EMITTER_COUNT];
+static int nextAvailableEmitter;
+static int emitterExtent;
+static bool dropAlive[MAX_DROP_COUNT];
+static unsigned short dropGenerations[MAX_DROP_COUNT];
+static Vector2 dropPositions[MAX_DROP_COUNT];
+static Vector2 dropVelocities[MAX_DROP_COUNT];
+static float dropRadii[MAX_DROP_COUNT];
+static Color dropColors[MAX_DROP_COUNT];
+static unsigned char dropKinds[MAX_DROP_COUNT];
+static int nextAvailableDrop;
+static int dropExtent;
+static bool powerUpActive[POWER_UP_COUNT];
+static EntityHandle powerUpTimers[POWER_UP_COUNT];
+static bool playerReloading;
+static bool slowTimeSkip;
+static EntityHandle ufoTimer;
+static EntityHandle reloadTimer;
+static Timer timers[MAX_TIMER_COUNT];
+static short timerSlots[TIMER_WHEEL_LEVEL_COUNT * TIMER_WHEEL_SLOT_COUNT];
+static short freeTimer;
+static unsigned int timerTick;
+static float timerClock;
+static int score;
+static int homingMissilesRemaining;
+static short homingGridStarts[HOMING_GRID_CELL_COUNT + 1];
+static unsigned char homingGridAliens[MAX_ALIEN_COUNT];
 static int wave;
 static float frameTime;
-static float readyElapsed;
-static float winElapsed;
-static float loseElapsed;
-static int alienFrameIndex;
-static float alienFrameElapsed;
 static bool alienDirection;
+static float formationLeft;
+static float formationRight;
+static float formationBottom;
+static bool formationLanded;
+static bool waveSnapshotPending;
+static int preloadedAlienRows;
 static int alienCount;
+static EntityHandle playerKiller;
+static unsigned int input;
+static unsigned int randomState;
+static int instanceCount = 1;
+static int activeInstance;
+static unsigned char *instanceStates[MAX_INSTANCE_COUNT];
+static unsigned char *waveSnapshots[MAX_INSTANCE_COUNT];
+static WaveText waveTexts[MAX_INSTANCE_COUNT][2];
+static unsigned int pressedInputs[MAX_INSTANCE_COUNT];
+static unsigned int heldInputs[MAX_INSTANCE_COUNT];
+static float updateClock;
+static FILE *replayRecordFile;
+static ReplayHeader replayRecordHeader;
+static ReplayBlock replayRecordBlock;
+static int replayRecordRunCount;
+static ReplayIndexEntry *replayBlockEntries;
+static int replayBlockCapacity;
+static ReplayIndexEntry *replayKeyframeEntries;
+static int replayKeyframeCapacity;
+static unsigned char *replayKeyframeBuffer;
+static bool replayPlaying;
+static const unsigned char *replayData;
+static long replayDataSize;
+static const ReplayHeader *replayHeader;
+static const ReplayIndexEntry *replayBlockIndex;
+static const ReplayIndexEntry *replayKeyframeIndex;
+static unsigned int replayTick;
+static int replayBlock;
+static int replayRun;
+static int replayRunTick;
+static const AttractDemo *attractDemo;
+static int attractDemoIndex;
+static int attractRun;
+static int attractRunTick;
+static int attractIdleTicks;
+static bool mixerReady;
+static Voice voices[MAX_VOICE_COUNT];
+static VoiceCommand voiceQueue[VOICE_QUEUE_SIZE];
+static atomic_uint voiceQueueHead;
+static atomic_uint voiceQueueTail;
+static atomic_uint mixerCallbackCount;
+static atomic_uint mixerLastNanoseconds;
+static atomic_uint mixerMaxNanoseconds;
+static atomic_ullong mixerTotalNanoseconds;
+static HighScoreRecord highScores[HIGH_SCORE_COUNT];
+static int highScoreCount;
+static bool highScoreReady;
+static char highScoreLogPath[MAX_PATH_LENGTH];
+static char highScoreCompactPath[MAX_PATH_LENGTH];
+static int droppedHighScoreCount;
+#if !defined(_WIN32)
+static int highScoreLog = -1;
+static int highScoreLogRecords;
+static HighScoreRecord loggedHighScores[HIGH_SCORE_COUNT];
+static int loggedHighScoreCount;
+static HighScoreRecord highScoreQueue[HIGH_SCORE_QUEUE_SIZE];
+static unsigned int highScoreQueueHead;
+static unsigned int highScoreQueueTail;
+static bool highScoreStopping;
+static pthread_t highScoreThread;
+static pthread_mutex_t highScoreMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t highScoreCondition = PTHREAD_COND_INITIALIZER;
+#endif
+static const char *automationPath;
+static int automationListener = -1;
+static int automationClient = -1;
+static AutomationRequest automationRequest;
+static int automationRequestSize;
+static bool automationPaused;
+static unsigned int automationInput;
+static unsigned int automationStepTicks;
+static AutomationReply automationStepReply;
+static void *botLibrary;
+static SpaceInvadersBotUpdateFunction botUpdate;
+static SpaceInvadersBotShutdownFunction botShutdown;
+static unsigned int botBudgetNanoseconds = defaultBotBudgetNanoseconds;
+static unsigned int botCallCount;
+static unsigned int botLastNanoseconds;
+static unsigned int botMaxNanoseconds;
+static unsigned long long botTotalNanoseconds;
+static unsigned int botOverBudgetCount;
+static bool captureActive;
+static ReadbackTargets captureTargets;
+static unsigned char *captureFrames;
+static unsigned char *captureIndices;
+static unsigned int captureWrittenFrames;
+static unsigned int captureSessionFirst;
+static float captureClock;
+static Color capturePalette[CAPTURE_PALETTE_SIZE];
+static int capturePaletteSize;
+static unsigned char captureLookup[CAPTURE_LOOKUP_SIZE];
+static unsigned int captureLzwKeys[CAPTURE_LZW_HASH_SIZE];
+static unsigned short captureLzwCodes[CAPTURE_LZW_HASH_SIZE];
+static char capturePath[64];
+static unsigned int captureClipFirst;
+static unsigned int captureClipLast;
+static atomic_uint captureEncodedFrame;
+static atomic_bool captureEncoding;
+#if !defined(_WIN32)
+static bool captureStopping;
+static pthread_t captureThread;
+static pthread_mutex_t captureMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t captureCondition = PTHREAD_COND_INITIALIZER;
+#endif
+static bool screenshotReady;
+static bool screenshotRequested;
+static ReadbackTargets screenshotTargets;
+static char screenshotPaths[READBACK_TARGET_COUNT][48];
+static unsigned int screenshotCount;
+#if !defined(_WIN32)
+static ScreenshotJob screenshotQueue[SCREENSHOT_QUEUE_SIZE];
+static unsigned int screenshotQueueHead;
+static unsigned int screenshotQueueTail;
+static bool screenshotStopping;
+static pthread_t screenshotThread;
+static pthread_mutex_t screenshotMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t screenshotCondition = PTHREAD_COND_INITIALIZER;
+#endif
+static unsigned int profiledFrameCount;
+static unsigned int profiledTickCount;
+static unsigned int updateNanoseconds;
+static unsigned int updateMaxNanoseconds;
+static unsigned int drawNanoseconds;
+static unsigned int drawMaxNanoseconds;
+static StartupPhase startupPhases[MAX_STARTUP_PHASE_COUNT];
+static int startupPhaseCount;
+static double startupPhaseStart;
+static long startupResidentBefore;
+static long startupResidentAfter;
+
+static const Archetype archetypes[ARCHETYPE_COUNT] = {
+    { positionComponent | spriteComponent, 1, &nextAvailablePlayer, &playerExtent, playerAlive, playerGenerations, playerPositions, NULL, NULL, NULL, NULL, &playerTexture, NULL, 1, NULL, 1, NULL, NULL, NULL, NULL, NULL },
+    { positionComponent | velocityComponent | spriteComponent, MAX_ALIEN_COUNT, &nextAvailableAlien, &alienExtent, alienAlive, alienGenerations, alienPositions, alienVelocities, NULL, NULL, NULL, &alienTexture, alienPhases, 2, alienTypeIds, ALIEN_TYPE_COUNT, NULL, NULL, NULL, NULL, NULL },
+    { positionComponent | velocityComponent | circleComponent | boundedComponent, MAX_PLAYER_BULLET_COUNT, &nextAvailablePlayerBullet, &playerBulletExtent, playerBulletAlive, playerBulletGenerations, playerBulletPositions, playerBulletVelocities, playerBulletRadii, playerBulletColors, NULL, NULL, NULL, 0, NULL, 1, NULL, NULL, NULL, NULL, NULL },
+    { positionComponent | velocityComponent | circleComponent | ownerComponent | boundedComponent | oscillatorComponent, MAX_ALIEN_BULLET_COUNT, &nextAvailableAlienBullet, &alienBulletExtent, alienBulletAlive, alienBulletGenerations, alienBulletPositions, alienBulletVelocities, alienBulletRadii, alienBulletColors, alienBulletOwners, NULL, NULL, 0, NULL, 1, NULL, NULL, alienBulletAnchors, alienBulletDrifts, alienBulletSprings },
+    { positionComponent | spriteComponent | pathComponent, MAX_UFO_COUNT, &nextAvailableUfo, &ufoExtent, ufoAlive, ufoGenerations, ufoPositions, NULL, NULL, NULL, NULL, &ufoTexture, NULL, 1, NULL, 1, ufoPaths, ufoPathTicks, NULL, NULL, NULL },
+    { ownerComponent, MAX_EMITTER_COUNT, &nextAvailableEmitter, &emitterExtent, emitterAlive, emitterGenerations, NULL, NULL, NULL, NULL, emitterOwners, NULL, NULL, 0, NULL, 1, NULL, NULL, NULL, NULL, NULL },
+    { positionComponent | velocityComponent | circleComponent | boundedComponent, MAX_DROP_COUNT, &nextAvailableDrop, &dropExtent, dropAlive, dropGenerations, dropPositions, dropVelocities, dropRadii, dropColors, NULL, NULL, NULL, 0, dropKinds, POWER_UP_COUNT, NULL, NULL, NULL, NULL, NULL }
+};
+
+static const InstanceField instanceFields[] = {
+    { &gameState, sizeof(gameState), 0, NULL },
+    { &nextAvailablePlayer, sizeof(nextAvailablePlayer), 0, NULL },
+    { &playerExtent, sizeof(playerExtent), 0, NULL },
+    { playerAlive, sizeof(playerAlive), 0, NULL },
+    { playerGenerations, sizeof(playerGenerations), 0, NULL },
+    { playerPositions, sizeof(playerPositions), 0, NULL },
+    { &livesRemaining, sizeof(livesRemaining), 0, NULL },
+    { &camera, sizeof(camera), 0, NULL },
+    { &cameraBounds, sizeof(cameraBounds), 0, NULL },
+    { &nextAvailableAlien, sizeof(nextAvailableAlien), 0, NULL },
+    { &alienExtent, sizeof(alienExtent), 0, NULL },
+    { alienAlive, sizeof(alienAlive), sizeof(alienAlive[0]), &alienExtent },
+    { alienGenerations, sizeof(alienGenerations), 0, NULL },
+    { alienPositions, sizeof(alienPositions), sizeof(alienPositions[0]), &alienExtent },
+    { alienVelocities, sizeof(alienVelocities), sizeof(alienVelocities[0]), &alienExtent },
+    { alienTypeIds, sizeof(alienTypeIds), sizeof(alienTypeIds[0]), &alienExtent },
+    { alienHitPoints, sizeof(alienHitPoints), sizeof(alienHitPoints[0]), &alienExtent },
+    { alienHitFlashes, sizeof(alienHitFlashes), sizeof(alienHitFlashes[0]), &alienExtent },
+    { alienPhases, sizeof(alienPhases), sizeof(alienPhases[0]), &alienExtent },
+    { &nextAvailablePlayerBullet, sizeof(nextAvailablePlayerBullet), 0, NULL },
+    { &playerBulletExtent, sizeof(playerBulletExtent), 0, NULL },
+    { playerBulletAlive, sizeof(playerBulletAlive), sizeof(playerBulletAlive[0]), &playerBulletExtent },
+    { playerBulletGenerations, sizeof(playerBulletGenerations), 0, NULL },
+    { playerBulletPositions, sizeof(playerBulletPositions), sizeof(playerBulletPositions[0]), &playerBulletExtent },
+    { playerBulletVelocities, sizeof(playerBulletVelocities), sizeof(playerBulletVelocities[0]), &playerBulletExtent },
+    { playerBulletHomingRates, sizeof(playerBulletHomingRates), sizeof(playerBulletHomingRates[0]), &playerBulletExtent },
+    { playerBulletRadii, sizeof(playerBulletRadii), sizeof(playerBulletRadii[0]), &playerBulletExtent },
+    { playerBulletColors, sizeof(playerBulletColors), sizeof(playerBulletColors[0]), &playerBulletExtent },
+    { &nextAvailableAlienBullet, sizeof(nextAvailableAlienBullet), 0, NULL },
+    { &alienBulletExtent, sizeof(alienBulletExtent), 0, NULL },
+    { alienBulletAlive, sizeof(alienBulletAlive), sizeof(alienBulletAlive[0]), &alienBulletExtent },
+    { alienBulletGenerations, sizeof(alienBulletGenerations), 0, NULL },
+    { alienBulletPositions, sizeof(alienBulletPositions), sizeof(alienBulletPositions[0]), &alienBulletExtent },
+    { alienBulletVelocities, sizeof(alienBulletVelocities), sizeof(alienBulletVelocities[0]), &alienBulletExtent },
+    { alienBulletAnchors, sizeof(alienBulletAnchors), sizeof(alienBulletAnchors[0]), &alienBulletExtent },
+    { alienBulletDrifts, sizeof(alienBulletDrifts), sizeof(alienBulletDrifts[0]), &alienBulletExtent },
+    { alienBulletSprings, sizeof(alienBulletSprings), sizeof(alienBulletSprings[0]), &alienBulletExtent },
+    { alienBulletHomingRates, sizeof(alienBulletHomingRates), sizeof(alienBulletHomingRates[0]), &alienBulletExtent },
+    { alienBulletRadii, sizeof(alienBulletRadii), sizeof(alienBulletRadii[0]), &alienBulletExtent },
+    { alienBulletColors, sizeof(alienBulletColors), sizeof(alienBulletColors[0]), &alienBulletExtent },
+    { alienBulletOwners, sizeof(alienBulletOwners), sizeof(alienBulletOwners[0]), &alienBulletExtent },
+    { &nextAvailableUfo, sizeof(nextAvailableUfo), 0, NULL },
+    { &ufoExtent, sizeof(ufoExtent), 0, NULL },
+    { ufoAlive, sizeof(ufoAlive), sizeof(ufoAlive[0]), &ufoExtent },
+    { ufoGenerations, sizeof(ufoGenerations), 0, NULL },
+    { ufoPositions, sizeof(ufoPositions), sizeof(ufoPositions[0]), &ufoExtent },
+    { ufoPaths, sizeof(ufoPaths), sizeof(ufoPaths[0]), &ufoExtent },
+    { ufoPathTicks, sizeof(ufoPathTicks), sizeof(ufoPathTicks[0]), &ufoExtent },
+    { &nextAvailableEmitter, sizeof(nextAvailableEmitter), 0, NULL },
+    { &emitterExtent, sizeof(emitterExtent), 0, NULL },
+    { emitterAlive, sizeof(emitterAlive), sizeof(emitterAlive[0]), &emitterExtent },
+    { emitterGenerations, sizeof(emitterGenerations), 0, NULL },
+    { emitterOwners, sizeof(emitterOwners), sizeof(emitterOwners[0]), &emitterExtent },
+    { emitterStates, sizeof(emitterStates), sizeof(emitterStates[0]), &emitterExtent },
+    { &nextAvailableDrop, sizeof(nextAvailableDrop), 0, NULL },
+    { &dropExtent, sizeof(dropExtent), 0, NULL },
+    { dropAlive, sizeof(dropAlive), sizeof(dropAlive[0]), &dropExtent },
+    { dropGenerations, sizeof(dropGenerations), 0, NULL },
+    { dropPositions, sizeof(dropPositions), sizeof(dropPositions[0]), &dropExtent },
+    { dropVelocities, sizeof(dropVelocities), sizeof(dropVelocities[0]), &dropExtent },
+    { dropRadii, sizeof(dropRadii), sizeof(dropRadii[0]), &dropExtent },
+    { dropColors, sizeof(dropColors), sizeof(dropColors[0]), &dropExtent },
+    { dropKinds, sizeof(dropKinds), sizeof(dropKinds[0]), &dropExtent },
+    { powerUpActive, sizeof(powerUpActive), 0, NULL },
+    { powerUpTimers, sizeof(powerUpTimers), 0, NULL },
+    { &playerReloading, sizeof(playerReloading), 0, NULL },
+    { &slowTimeSkip, sizeof(slowTimeSkip), 0, NULL },
+    { &ufoTimer, sizeof(ufoTimer), 0, NULL },
+    { &reloadTimer, sizeof(reloadTimer), 0, NULL },
+    { timers, sizeof(timers), 0, NULL },
+    { timerSlots, sizeof(timerSlots), 0, NULL },
+    { &freeTimer, sizeof(freeTimer), 0, NULL },
+    { &timerTick, sizeof(timerTick), 0, NULL },
+    { &timerClock, sizeof(timerClock), 0, NULL },
+    { &score, sizeof(score), 0, NULL },
+    { &homingMissilesRemaining, sizeof(homingMissilesRemaining), 0, NULL },
+    { &wave, sizeof(wave), 0, NULL },
+    { &frameTime, sizeof(frameTime), 0, NULL },
+    { &alienDirection, sizeof(alienDirection), 0, NULL },
+    { &formationLeft, sizeof(formationLeft), 0, NULL },
+    { &formationRight, sizeof(formationRight), 0, NULL },
+    { &formationBottom, sizeof(formationBottom), 0, NULL },
+    { &formationLanded, sizeof(formationLanded), 0, NULL },
+    { &waveSnapshotPending, sizeof(waveSnapshotPending), 0, NULL },
+    { &preloadedAlienRows, sizeof(preloadedAlienRows), 0, NULL },
+    { &alienCount, sizeof(alienCount), 0, NULL },
+    { &playerKiller, sizeof(playerKiller), 0, NULL },
+    { &input, sizeof(input), 0, NULL },
+    { &randomState, sizeof(randomState), 0, NULL }
+};
 
 //////////////////////////////////////////////////////////////////////
 // FUNCTION PROTOTYPES
@@ -156,14 +1088,43 @@ void Update();
 void Draw();
 void Terminate();
 
-void FromStartToReadyState();
-void FromReadyToPlayState();
-void FromPlayToWinState();
-void FromPlayToLoseState();
-void FromWinToReadyState();
-void FromLoseToReadyState();
-void FromLoseToStartState();
+void ResetGame();
+void UpdateTick();
+void UpdateSimulation();
+unsigned int ReadInput(int instance);
+void SeedRandom(unsigned int seed);
+int RandomValue(int min, int max);
+int GetWaveRowCount(int waveNumber);
+int GetWaveFireOdds(int waveNumber);
+
+void CreateInstances();
+void SelectInstance(int instance);
+void DrawInstance(int instance);
+int GetGameStateSize();
+int GetInstanceFieldSize(const InstanceField *field);
+int SaveGameState(unsigned char *buffer);
+bool LoadGameState(const unsigned char *buffer, int size);
+bool IsGameStateValid(const unsigned char *buffer, int size);
+bool AreGameStateValuesValid(const unsigned char *buffer, const int *offsets, const int *extents);
+bool IsTimerWheelValid(const Timer *wheel, const short *slots, unsigned int tick);
+const unsigned char *FindGameStateField(const unsigned char *buffer, const int *offsets, const void *data);
+void SaveWaveSnapshot();
+bool RestartWave();
+
+void ChangeGameState(GameState state);
+void EnterStartState();
+void EnterReadyState();
+void EnterPlayState();
+void ExitPlayState();
+void EnterWinState();
+void ExitWinState();
+void EnterLoseState();
+void ExitLoseState();
+void PreloadReadyState();
+void PreloadPlayState();
+const WaveText *GetWaveText(int waveNumber);
 
+void DrawGameState();
 void DrawStartState();
 void DrawReadyState();
 void DrawPlayState();
@@ -171,20 +1132,180 @@ void DrawWinState();
 void DrawLoseState();
 
 void DrawBottomShelf();
-void DrawPlayer();
-void DrawAliens();
-void DrawBullets();
+void DrawWorld();
+void DrawKillerHighlight();
+void DrawHitFlashes();
+void DrawShield();
 
 void UpdateStartState();
-void UpdateReadyState();
 void UpdatePlayState();
-void UpdateWinState();
-void UpdateLoseState();
 
-void UpdateAlienAnimations();
+void ClearTimers();
+void AdvanceTimers();
+void AdvanceTimerWheel();
+EntityHandle ScheduleTimer(TimerEvent event, int ticks, EntityHandle argument, unsigned char payload);
+void CancelTimer(EntityHandle handle);
+void InsertTimer(int timer);
+void UnlinkTimer(int timer);
+void HandleTimer(TimerEvent event, EntityHandle argument, unsigned char payload);
+int SecondsToTicks(float seconds);
+
+void SpawnDrop(Vector2 position);
+void ActivatePowerUp(PowerUpId powerUp);
+void ClearPowerUps();
+
+void BuildUfoPaths();
+Vector2 GetCatmullRomPoint(Vector2 p0, Vector2 p1, Vector2 p2, Vector2 p3, float t);
 
 void ShootPlayerBullet();
 void ShootAlienBullet(int alienIndex);
+void ShootPatternBullet(const BulletEmitter *emitter, Vector2 position, float angle, EntityHandle owner);
+
+bool BuildBulletPatterns();
+bool CompileBulletPattern(const char *source, unsigned char *code, int codeSize);
+bool IsBulletPatternOffsetValid(int pattern, int offset);
+
+int SpawnEntity(ArchetypeId archetype);
+void DespawnEntity(ArchetypeId archetype, int index);
+void ClearArchetype(ArchetypeId archetype);
+int CountEntities(ArchetypeId archetype);
+void SteerFormationSystem();
+void UpdateFormationExtents();
+bool MarchFormationSystem();
+void FireAlienSystem();
+void SpawnUfo();
+void FollowPathSystem();
+void RunEmitterSystem();
+void OscillateSystem(ArchetypeId archetype);
+void HomingSystem();
+void BuildHomingGrid();
+int GetHomingCell(Vector2 point);
+int FindNearestAlien(Vector2 point);
+void IntegrateSystem(ArchetypeId archetype);
+bool UpdateCollisionSystem();
+void CullSystem();
+void DrawSpriteSystem();
+float GetAnimationTime();
+int GetAnimationFrame(float animationTime, unsigned char phase, int frameCount);
+bool BeginAnimationShader(const Archetype *type, float animationTime);
+void DrawCircleSystem();
+
+EntityHandle MakeHandle(int index, unsigned short generation);
+int GetHandleIndex(EntityHandle handle);
+unsigned short GetHandleGeneration(EntityHandle handle);
+unsigned short NextGeneration(unsigned short generation);
+EntityHandle GetEntityHandle(ArchetypeId archetype, int index);
+bool IsEntityHandleValid(ArchetypeId archetype, EntityHandle handle);
+
+float *RenderSoundEffect(SoundEffect effect, int *frameCount);
+void PlaySoundEffect(SoundEffectId effect, float x);
+void MixSoundEffects(void *bufferData, unsigned int frames);
+void MixVoice(float *output, const float *samples, int frameCount, float leftGain, float rightGain);
+void PrintMixerReport();
+
+bool BeginReplayRecording(const char *path);
+void RecordReplayTick(unsigned int keys);
+void FlushReplayBlock();
+void WriteReplayKeyframe();
+void AppendReplayIndexEntry(ReplayIndexEntry **entries, int *capacity, unsigned int count, ReplayIndexEntry entry);
+void EndReplayRecording();
+bool OpenReplay(const char *path);
+bool IsReplayValid();
+bool SeekReplay(unsigned int tick);
+bool NextReplayInput(unsigned int *keys);
+void CloseReplay();
+
+void UpdateAttractMode();
+void StartAttractDemo();
+bool NextAttractInput(unsigned int *keys);
+void StopAttractDemo();
+void DrawAttractOverlay();
+
+bool LoadHighScores();
+void SubmitHighScore(int finalScore, int finalWave);
+void StopHighScoreWriter();
+bool InsertHighScore(HighScoreRecord *table, int *count, HighScoreRecord record);
+unsigned int GetHighScoreChecksum(const HighScoreRecord *record);
+#if !defined(_WIN32)
+void *RunHighScoreWriter(void *argument);
+void AppendHighScoreRecord(HighScoreRecord record);
+void CompactHighScoreLog();
+#endif
+
+bool OpenAutomation(const char *path);
+void ServiceAutomation();
+void ExecuteAutomationRequest(AutomationRequest request, AutomationReply *reply);
+void CloseAutomation();
+
+bool LoadBot(const char *path);
+unsigned int UpdateBot();
+void PrintBotReport();
+void UnloadBot();
+
+bool StartCapture();
+void CaptureFrame();
+void StoreCaptureFrame(Image frame);
+void SaveCapture();
+void StopCapture();
+void CloseCapture();
+void BuildCapturePalette();
+void AddCaptureColor(Color color);
+void BuildCaptureLookup();
+#if !defined(_WIN32)
+void *RunCaptureEncoder(void *argument);
+#endif
+void EncodeCapture();
+void EncodeGifFrame(FILE *file, const unsigned char *indices, int count);
+void WriteGifCode(GifBitWriter *writer, int code, int codeSize);
+void FlushGifBlock(GifBitWriter *writer);
+void WriteGifWord(FILE *file, int value);
+
+void LoadReadbackTargets(ReadbackTargets *readback, int width, int height);
+void UnloadReadbackTargets(ReadbackTargets *readback);
+bool BeginReadbackTarget(ReadbackTargets *readback);
+void EndReadbackTarget(ReadbackTargets *readback);
+int ReadReadbackTarget(ReadbackTargets *readback, Image *image);
+
+bool StartScreenshotWriter();
+void RequestScreenshot();
+void ReadScreenshots();
+void WriteScreenshot(ScreenshotJob *job);
+#if !defined(_WIN32)
+void *RunScreenshotWriter(void *argument);
+#endif
+void StopScreenshotWriter();
+
+void TraceStartupPhase(const char *name);
+void PrintStartupReport();
+long GetResidentBytes();
+
+int RunBalanceAnalyzer(int argc, char *argv[]);
+void SimulateBalanceTrials(int firstWave, int lastWave, int trialCount, int jobIndex, int jobCount, unsigned int seed, ScriptedPlayer profile, int maxTicks, BalanceWaveResult *results);
+int SimulateBalanceTrial(int trialWave, ScriptedPlayer *profile, int maxTicks);
+unsigned int UpdateScriptedPlayer(ScriptedPlayer *profile);
+unsigned int HashSeed(unsigned int seed, unsigned int a, unsigned int b);
+int GetHistogramPercentile(const unsigned int *histogram, int tickCount, unsigned int total, float percentile);
+
+int RunStressSearch(int argc, char *argv[]);
+void RecordScriptedStressCase(StressCase *stressCase);
+void EvaluateStressCase(StressCase *stressCase);
+void MutateStressCase(StressCase *child, const StressCase *parent, const StressCase *donor);
+bool WriteStressFixture(const char *path, const StressCase *stressCase);
+bool ReadStressFixture(const char *path, StressCase *stressCase);
+unsigned int GetStressCaseHash(const StressCase *stressCase);
+double GetTimestamp();
+
+int RunEcsBenchmark(int argc, char *argv[]);
+
+int RunAttractRecorder(int argc, char *argv[]);
+
+static const GameStateDescriptor gameStates[GAME_STATE_COUNT] = {
+    { EnterStartState, NULL, UpdateStartState, DrawStartState, NULL, readyState },
+    { EnterReadyState, NULL, NULL, DrawReadyState, PreloadReadyState, playState },
+    { EnterPlayState, ExitPlayState, UpdatePlayState, DrawPlayState, PreloadPlayState, winState },
+    { EnterWinState, ExitWinState, NULL, DrawWinState, NULL, readyState },
+    { EnterLoseState, ExitLoseState, NULL, DrawLoseState, NULL, readyState }
+};
 
 //////////////////////////////////////////////////////////////////////
 // FUNCTIONS
@@ -192,10 +1313,55 @@ void ShootAlienBullet(int alienIndex);
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "--balance") == 0)
+    {
+        return RunBalanceAnalyzer(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--stress") == 0)
+    {
+        return RunStressSearch(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-ecs") == 0)
+    {
+        return RunEcsBenchmark(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--record-attract") == 0)
+    {
+        return RunAttractRecorder(argc - 2, argv + 2);
+    }
+    if (argc > 2 && strcmp(argv[1], "--players") == 0)
+    {
+        instanceCount = Clamp(atoi(argv[2]), 1, MAX_INSTANCE_COUNT);
+    }
     Initialize();
+    if (argc > 1 && strcmp(argv[1], "--startup-report") == 0)
+    {
+        PrintStartupReport();
+    }
+    float seekSeconds = 0;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (strcmp(argv[i], "--record") == 0)
+            BeginReplayRecording(argv[i + 1]);
+        else if (strcmp(argv[i], "--replay") == 0 && !OpenReplay(argv[i + 1]))
+            fprintf(stderr, "replay %s: missing or malformed\n", argv[i + 1]);
+        else if (strcmp(argv[i], "--seek") == 0)
+            seekSeconds = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--automation") == 0)
+            OpenAutomation(argv[i + 1]);
+        else if (strcmp(argv[i], "--bot-budget") == 0)
+            botBudgetNanoseconds = atof(argv[i + 1]) * 1000;
+        else if (strcmp(argv[i], "--bot") == 0)
+            LoadBot(argv[i + 1]);
+    }
+    if (replayPlaying && seekSeconds > 0)
+    {
+        SeekReplay(SecondsToTicks(seekSeconds));
+    }
     while (!WindowShouldClose())
     {
         Update();
+        ServiceAutomation();
         Draw();
     }
     Terminate();
@@ -204,440 +1370,4053 @@ int main(int argc, char *argv[])
 
 void Initialize()
 {
+    startupResidentBefore = GetResidentBytes();
+    startupPhaseCount = 0;
+    startupPhaseStart = GetTimestamp();
     InitWindow(screenWidth, screenHeight, "Space Invaders");
     SetTargetFPS(targetFPS);
+    TraceStartupPhase("InitWindow");
     playerTexture = LoadTexture("Player.png");
+    TraceStartupPhase("LoadTexture Player.png");
     alienTexture = LoadTexture("Alien.png");
+    TraceStartupPhase("LoadTexture Alien.png");
+    ufoTexture = LoadTexture("Ufo.png");
+    TraceStartupPhase("LoadTexture Ufo.png");
+    alienShader = LoadShader("Alien.vs", NULL);
+    alienShaderTimeLocation = GetShaderLocation(alienShader, "animationTime");
+    alienShaderFrameWidthLocation = GetShaderLocation(alienShader, "frameWidth");
+    alienShaderFrameCountLocation = GetShaderLocation(alienShader, "frameCount");
+    TraceStartupPhase("LoadShader Alien.vs");
+    BuildUfoPaths();
+    TraceStartupPhase("BuildUfoPaths");
+    BuildBulletPatterns();
+    TraceStartupPhase("BuildBulletPatterns");
     InitAudioDevice();
-    shootSound = LoadSound("Shoot.wav");
-    playerDeathSound = LoadSound("PlayerDeath.wav");
-    alienDeathSound = LoadSound("AlienDeath.wav");
+    TraceStartupPhase("InitAudioDevice");
+    for (int i = 0; i < SOUND_EFFECT_COUNT; ++i)
+    {
+        soundEffectSamples[i] = RenderSoundEffect(soundEffects[i], &soundEffectFrameCounts[i]);
+        char phaseName[48];
+        snprintf(phaseName, sizeof(phaseName), "RenderSoundEffect %s", soundEffectNames[i]);
+        TraceStartupPhase(phaseName);
+    }
     music = LoadMusicStream("Music.wav");
     PlayMusicStream(music);
+    TraceStartupPhase("LoadMusicStream Music.wav");
+    SetAudioStreamBufferSizeDefault(mixerBufferFrames);
+    mixerStream = LoadAudioStream(soundEffectSampleRate, 32, 2);
+    SetAudioStreamBufferSizeDefault(0);
+    SetAudioStreamCallback(mixerStream, MixSoundEffects);
+    PlayAudioStream(mixerStream);
+    mixerReady = true;
+    TraceStartupPhase("LoadAudioStream mixer");
+    SeedRandom((unsigned int)time(NULL));
+    ResetGame();
+    TraceStartupPhase("ResetGame");
+    CreateInstances();
+    TraceStartupPhase("CreateInstances");
+    LoadHighScores();
+    TraceStartupPhase("LoadHighScores");
+    StartScreenshotWriter();
+    TraceStartupPhase("StartScreenshotWriter");
+    startupResidentAfter = GetResidentBytes();
+}
+
+void ResetGame()
+{
     gameState = startState;
-    player.position = (Vector2) { screenHalfWidth - playerHalfWidth, screenHalfHeight - playerHalfHeight };
-    player.livesRemaining = 3;
-    player.alive = true;
+    playerPositions[0] = (Vector2) { screenHalfWidth - playerHalfWidth, screenHalfHeight - playerHalfHeight };
+    playerAlive[0] = true;
+    livesRemaining = 3;
     camera.offset = (Vector2) { screenHalfWidth, screenHalfHeight };
-    camera.target = (Vector2) { player.position.x + playerHalfWidth, player.position.y + playerHalfHeight - 50 };
+    camera.target = (Vector2) { playerPositions[0].x + playerHalfWidth, playerPositions[0].y + playerHalfHeight - 50 };
     camera.rotation = 0;
     camera.zoom = cameraZoom;
     cameraBounds = (Rectangle) { 360, 150, screenWidth * 0.25, screenHeight * 0.25 };
-    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
-    {
-        aliens[i].alive = false;
-    }
+    nextAvailablePlayer = 0;
+    ClearArchetype(alienArchetype);
     nextAvailableAlien = 0;
-    for (int i = 0; i < MAX_BULLET_COUNT; ++i)
-    {
-        bullets[i].active = false;
-    }
-    nextAvailableBullet = 0;
+    ClearArchetype(playerBulletArchetype);
+    nextAvailablePlayerBullet = 0;
+    ClearArchetype(alienBulletArchetype);
+    nextAvailableAlienBullet = 0;
+    ClearArchetype(ufoArchetype);
+    nextAvailableUfo = 0;
+    ClearArchetype(emitterArchetype);
+    nextAvailableEmitter = 0;
+    ClearArchetype(dropArchetype);
+    nextAvailableDrop = 0;
+    ClearTimers();
+    ClearPowerUps();
+    ufoTimer = nullHandle;
+    slowTimeSkip = false;
+    score = 0;
+    homingMissilesRemaining = 0;
     wave = 1;
     frameTime = 0;
-    readyElapsed = 0;
-    winElapsed = 0;
-    loseElapsed = 0;
-    alienFrameIndex = 0;
-    alienFrameElapsed = 0;
     alienDirection = 0;
+    formationLeft = 0;
+    formationRight = 0;
+    formationBottom = 0;
+    formationLanded = false;
+    waveSnapshotPending = false;
+    preloadedAlienRows = 0;
     alienCount = 0;
+    playerKiller = nullHandle;
+    input = 0;
 }
 
 void Update()
 {
-    frameTime = GetFrameTime();
-    if (gameState == startState)
-        UpdateStartState();
-    else if (gameState == readyState)
-        UpdateReadyState();
-    else if (gameState == playState)
-        UpdatePlayState();
-    else if (gameState == winState)
-        UpdateWinState();
-    else if (gameState == loseState)
-        UpdateLoseState();
+    const double start = GetTimestamp();
+    for (int i = 0; i < instanceCount; ++i)
+    {
+        const unsigned int keys = ReadInput(i);
+        pressedInputs[i] |= keys & shootInput;
+        heldInputs[i] = keys & ~shootInput;
+        if (i == 0 && IsKeyPressed(KEY_R) && replayRecordFile == NULL && !replayPlaying)
+        {
+            SelectInstance(i);
+            if (gameState == playState)
+                RestartWave();
+        }
+    }
+    updateClock = automationPaused ? 0 : fminf(updateClock + GetFrameTime(), maxFrameTime);
+    while (updateClock >= tickTime)
+    {
+        updateClock -= tickTime;
+        UpdateTick();
+    }
     UpdateMusicStream(music);
     if (IsKeyPressed(KEY_M))
-        IsMusicPlaying(music) ? PauseMusicStream(music) : ResumeMusicStream(music);
-}
-
-void Draw()
-{
-    BeginDrawing();
-    ClearBackground(BLACK);
-    if (gameState == startState)
-        DrawStartState();
-    else if (gameState == readyState)
-        DrawReadyState();
-    else if (gameState == playState)
-        DrawPlayState();
-    else if (gameState == winState)
-        DrawWinState();
-    else if (gameState == loseState)
-        DrawLoseState();
-    EndDrawing();
+        IsMusicStreamPlaying(music) ? PauseMusicStream(music) : ResumeMusicStream(music);
+    if (IsKeyPressed(KEY_F2))
+        PrintStartupReport();
+    if (IsKeyPressed(KEY_F3))
+        PrintMixerReport();
+    if (IsKeyPressed(KEY_F4))
+        PrintBotReport();
+    if (IsKeyPressed(KEY_F5))
+    {
+        if (captureActive)
+            StopCapture();
+        else
+            StartCapture();
+    }
+    if (IsKeyPressed(KEY_F6))
+        SaveCapture();
+    if (IsKeyPressed(KEY_F7))
+        RequestScreenshot();
+    updateNanoseconds = (GetTimestamp() - start) * 1e9;
+    if (updateNanoseconds > updateMaxNanoseconds)
+        updateMaxNanoseconds = updateNanoseconds;
+    ++profiledFrameCount;
 }
 
-void Terminate()
+void UpdateTick()
 {
-    UnloadMusicStream(music);
-    UnloadSound(shootSound);
-    UnloadSound(playerDeathSound);
-    UnloadSound(alienDeathSound);
-    UnloadTexture(playerTexture);
-    UnloadTexture(alienTexture);
-    CloseAudioDevice();
-    CloseWindow();
+    for (int i = 0; i < instanceCount; ++i)
+    {
+        SelectInstance(i);
+        input = pressedInputs[i] | heldInputs[i];
+        pressedInputs[i] = 0;
+        if (i == 0 && botUpdate != NULL)
+            input = UpdateBot();
+        if (i == 0)
+            input |= automationInput;
+        if (i == 0 && attractDemo != NULL && (input != 0 || !NextAttractInput(&input)))
+            StopAttractDemo();
+        if (i == 0 && replayPlaying && !NextReplayInput(&input))
+            CloseReplay();
+        if (i == 0)
+            RecordReplayTick(input);
+        frameTime = tickTime;
+        UpdateSimulation();
+        if (i == 0)
+            UpdateAttractMode();
+    }
+    ++profiledTickCount;
 }
 
-void FromStartToReadyState()
+void UpdateSimulation()
 {
-    gameState = readyState;
+    AdvanceTimers();
+    if (gameStates[gameState].update != NULL)
+        gameStates[gameState].update();
+    const GameState nextState = gameStates[gameState].nextState;
+    if (gameStates[nextState].preload != NULL)
+        gameStates[nextState].preload();
 }
 
-void FromReadyToPlayState()
+unsigned int ReadInput(int instance)
 {
-    gameState = playState;
-    readyElapsed = 0;
-    const int rows = Clamp(wave / 3 + 1, 1, 5);
-    for (int row = 0; row < rows; ++row)
-    {
-        for (int column = -7; column <= 7; ++column)
-        {
-            aliens[nextAvailableAlien].position = (Vector2) { camera.target.x - column * (alienWidth + alienHalfWidth), cameraBounds.y + 10 + (alienHeight + alienHalfHeight) * (row + 1) };
-            aliens[nextAvailableAlien].alive = true;
-            ++nextAvailableAlien;
-            nextAvailableAlien %= MAX_ALIEN_COUNT;
-            ++alienCount;
-        }
-    }
+    const int *keysForInstance = instanceKeys[instance];
+    unsigned int keys = 0;
+    if (IsKeyDown(keysForInstance[0]))
+        keys |= leftInput;
+    if (IsKeyDown(keysForInstance[1]))
+        keys |= rightInput;
+    if (IsKeyPressed(keysForInstance[2]))
+        keys |= shootInput;
+    if (IsKeyDown(keysForInstance[2]))
+        keys |= shootHeldInput;
+    return keys;
 }
 
-void FromPlayToWinState()
+void SeedRandom(unsigned int seed)
 {
-    gameState = winState;
-    for (int i = 0; i < MAX_BULLET_COUNT; ++i)
-    {
-        bullets[i].active = false;
-    }
+    randomState = seed != 0 ? seed : 1;
 }
 
-void FromPlayToLoseState()
+int RandomValue(int min, int max)
 {
-    gameState = loseState;
-    for (int i = 0; i < MAX_BULLET_COUNT; ++i)
-    {
-        bullets[i].active = false;
-    }
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return min + (int)(randomState % (unsigned int)(max - min + 1));
 }
 
-void FromWinToReadyState()
+int GetWaveRowCount(int waveNumber)
 {
-    gameState = readyState;
-    winElapsed = 0;
-    player.position = (Vector2) { screenHalfWidth - playerHalfWidth, screenHalfHeight - playerHalfHeight };
-    ++wave;
+    return Clamp(waveNumber / 3 + 1, 1, MAX_ALIEN_ROW_COUNT);
 }
 
-void FromLoseToReadyState()
+int GetWaveFireOdds(int waveNumber)
 {
-    gameState = readyState;
-    loseElapsed = 0;
-    player.position = (Vector2) { screenHalfWidth - playerHalfWidth, screenHalfHeight - playerHalfHeight };
-    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
-    {
-        aliens[i].alive = false;
-    }
-    alienCount = 0;
-    --player.livesRemaining;
+    return Clamp(300 - (waveNumber - 1) * 10, 120, 300);
 }
 
-void FromLoseToStartState()
+void CreateInstances()
 {
-    gameState = startState;
-    loseElapsed = 0;
-    player.position = (Vector2) { screenHalfWidth - playerHalfWidth, screenHalfHeight - playerHalfHeight };
-    player.livesRemaining = 3;
-    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+    activeInstance = 0;
+    if (instanceCount == 1)
+        return;
+    const unsigned int seed = randomState;
+    for (int i = 0; i < instanceCount; ++i)
     {
-        aliens[i].alive = false;
+        SeedRandom(HashSeed(seed, i, 0));
+        instanceStates[i] = RL_MALLOC(GetGameStateSize());
+        SaveGameState(instanceStates[i]);
     }
-    alienCount = 0;
-    wave = 1;
+    LoadGameState(instanceStates[0], GetGameStateSize());
 }
 
-void DrawStartState()
+void SelectInstance(int instance)
 {
-    const int startHalfWidth = MeasureText("Press SHOOT To Play!", textSize) * 0.5;
-    DrawText("Press SHOOT To Play!", screenHalfWidth - startHalfWidth, 40, textSize, WHITE);
-    BeginMode2D(camera);
-    DrawPlayer();
-    EndMode2D();
+    if (instance == activeInstance)
+        return;
+    SaveGameState(instanceStates[activeInstance]);
+    LoadGameState(instanceStates[instance], GetGameStateSize());
+    activeInstance = instance;
 }
 
-void DrawReadyState()
+int GetGameStateSize()
 {
-    char readyBuffer[15];
-    sprintf(readyBuffer, "Ready Wave %d!", wave);
-    const int readyHalfWidth = MeasureText(readyBuffer, textSize) * 0.5;
-    DrawText(readyBuffer, screenHalfWidth - readyHalfWidth, 40, textSize, WHITE);
-    if (wave >= 19)
+    int size = 0;
+    for (int i = 0; i < INSTANCE_FIELD_COUNT; ++i)
     {
-        const int maxHalfWidth = MeasureText("Maximum Difficulty", textSize) * 0.5;
-        DrawText("Maximum Difficulty", screenHalfWidth - maxHalfWidth, 80, textSize, RED);
+        size += instanceFields[i].size;
     }
-    DrawBottomShelf();
-    BeginMode2D(camera);
-    DrawPlayer();
-    EndMode2D();
-}
-
-void DrawPlayState()
-{
-    DrawBottomShelf();
-    BeginMode2D(camera);
-    DrawPlayer();
-    DrawAliens();
-    DrawBullets();
-    EndMode2D();
+    return size;
 }
 
-void DrawWinState()
+int GetInstanceFieldSize(const InstanceField *field)
 {
-    char winBuffer[18];
-    sprintf(winBuffer, "Wave %d Complete!", wave);
-    const int winHalfWidth = MeasureText(winBuffer, textSize) * 0.5;
-    DrawText(winBuffer, screenHalfWidth - winHalfWidth, 40, textSize, WHITE);
-    DrawBottomShelf();
-    BeginMode2D(camera);
-    DrawPlayer();
-    DrawBullets();
-    EndMode2D();
+    return field->extent != NULL ? *field->extent * field->stride : field->size;
 }
 
-void DrawLoseState()
+int SaveGameState(unsigned char *buffer)
 {
-    const int loseHalfWidth = MeasureText("You died!", textSize) * 0.5;
-    DrawText("You died!", screenHalfWidth - loseHalfWidth, 40, textSize, WHITE);
-    DrawBottomShelf();
-    BeginMode2D(camera);
-    DrawAliens();
-    DrawBullets();
-    EndMode2D();
+    const unsigned char *start = buffer;
+    for (int i = 0; i < INSTANCE_FIELD_COUNT; ++i)
+    {
+        const int size = GetInstanceFieldSize(&instanceFields[i]);
+        memcpy(buffer, instanceFields[i].data, size);
+        buffer += size;
+    }
+    return buffer - start;
 }
 
-void DrawBottomShelf()
+bool LoadGameState(const unsigned char *buffer, int size)
 {
-    char livesBuffer[9];
-    sprintf(livesBuffer, "Lives: %d", player.livesRemaining);
-    DrawText(livesBuffer, 20, screenHeight - textSize - 20, textSize, WHITE);
-    char waveBuffer[9];
-    sprintf(waveBuffer, "Wave: %d", wave);
-    const int waveBufferWidth = MeasureText(waveBuffer, textSize);
-    DrawText(waveBuffer, screenWidth - waveBufferWidth - 20, screenHeight - textSize - 20, textSize, WHITE);
+    if (!IsGameStateValid(buffer, size))
+        return false;
+    int previousSizes[INSTANCE_FIELD_COUNT];
+    for (int i = 0; i < INSTANCE_FIELD_COUNT; ++i)
+    {
+        previousSizes[i] = GetInstanceFieldSize(&instanceFields[i]);
+    }
+    for (int i = 0; i < INSTANCE_FIELD_COUNT; ++i)
+    {
+        const int fieldSize = GetInstanceFieldSize(&instanceFields[i]);
+        memcpy(instanceFields[i].data, buffer, fieldSize);
+        if (previousSizes[i] > fieldSize)
+            memset((unsigned char *)instanceFields[i].data + fieldSize, 0, previousSizes[i] - fieldSize);
+        buffer += fieldSize;
+    }
+    return true;
 }
 
-void DrawPlayer()
+bool IsGameStateValid(const unsigned char *buffer, int size)
 {
-    DrawTextureV(playerTexture, player.position, WHITE);
+    const unsigned char *start = buffer;
+    int extents[ARCHETYPE_COUNT] = { 0 };
+    int offsets[INSTANCE_FIELD_COUNT];
+    for (int i = 0; i < INSTANCE_FIELD_COUNT; ++i)
+    {
+        const InstanceField *field = &instanceFields[i];
+        offsets[i] = buffer - start;
+        int fieldSize = field->size;
+        if (field->extent != NULL)
+        {
+            int a = 0;
+            while (a < ARCHETYPE_COUNT && archetypes[a].extent != field->extent)
+            {
+                ++a;
+            }
+            if (a == ARCHETYPE_COUNT || extents[a] > field->size / field->stride)
+                return false;
+            fieldSize = extents[a] * field->stride;
+        }
+        if (fieldSize > size)
+            return false;
+        for (int a = 0; a < ARCHETYPE_COUNT; ++a)
+        {
+            const Archetype *type = &archetypes[a];
+            if (field->data != type->extent && field->data != type->nextAvailable)
+                continue;
+            int value;
+            memcpy(&value, buffer, sizeof(value));
+            if (value < 0 || value > type->capacity)
+                return false;
+            if (field->data == type->extent)
+                extents[a] = value;
+        }
+        buffer += fieldSize;
+        size -= fieldSize;
+    }
+    return AreGameStateValuesValid(start, offsets, extents);
 }
 
-void DrawAliens()
+bool AreGameStateValuesValid(const unsigned char *buffer, const int *offsets, const int *extents)
 {
-    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+    GameState state;
+    memcpy(&state, FindGameStateField(buffer, offsets, &gameState), sizeof(state));
+    if (state < startState || state >= GAME_STATE_COUNT)
+        return false;
+    int waveNumber;
+    memcpy(&waveNumber, FindGameStateField(buffer, offsets, &wave), sizeof(waveNumber));
+    if (waveNumber < 1)
+        return false;
+    for (int a = 0; a < ARCHETYPE_COUNT; ++a)
     {
-        if (aliens[i].alive)
+        const Archetype *type = &archetypes[a];
+        const unsigned char *alive = FindGameStateField(buffer, offsets, type->alive);
+        const unsigned char *types = type->types != NULL ? FindGameStateField(buffer, offsets, type->types) : NULL;
+        const unsigned char *paths = type->paths != NULL ? FindGameStateField(buffer, offsets, type->paths) : NULL;
+        const unsigned char *pathTicks = type->pathTicks != NULL ? FindGameStateField(buffer, offsets, type->pathTicks) : NULL;
+        for (int i = 0; i < extents[a]; ++i)
         {
-            DrawTextureRec(alienTexture, (Rectangle) { alienFrameIndex * alienWidth, 0, alienWidth, alienHeight }, aliens[i].position, WHITE);
+            if (alive[i] > 1)
+                return false;
+            if (!alive[i])
+                continue;
+            if (types != NULL && types[i] >= type->typeCount)
+                return false;
+            if (paths == NULL)
+                continue;
+            int tick;
+            memcpy(&tick, pathTicks + i * sizeof(tick), sizeof(tick));
+            if (paths[i] >= UFO_PATH_COUNT || tick < -1 || tick >= ufoPathSampleCounts[paths[i]])
+                return false;
         }
     }
+    const unsigned char *emitterStateData = FindGameStateField(buffer, offsets, emitterStates);
+    const unsigned char *emitterAliveData = FindGameStateField(buffer, offsets, emitterAlive);
+    for (int i = 0; i < extents[emitterArchetype]; ++i)
+    {
+        BulletEmitter emitter;
+        memcpy(&emitter, emitterStateData + i * sizeof(emitter), sizeof(emitter));
+        if (emitterAliveData[i] && (emitter.pattern >= BULLET_PATTERN_COUNT || !IsBulletPatternOffsetValid(emitter.pattern, emitter.programCounter) || !IsBulletPatternOffsetValid(emitter.pattern, emitter.repeatStart)))
+            return false;
+    }
+    Timer wheel[MAX_TIMER_COUNT];
+    short slots[TIMER_WHEEL_LEVEL_COUNT * TIMER_WHEEL_SLOT_COUNT + 1];
+    unsigned int tick;
+    memcpy(wheel, FindGameStateField(buffer, offsets, timers), sizeof(timers));
+    memcpy(slots, FindGameStateField(buffer, offsets, timerSlots), sizeof(timerSlots));
+    memcpy(&slots[TIMER_WHEEL_LEVEL_COUNT * TIMER_WHEEL_SLOT_COUNT], FindGameStateField(buffer, offsets, &freeTimer), sizeof(freeTimer));
+    memcpy(&tick, FindGameStateField(buffer, offsets, &timerTick), sizeof(tick));
+    if (!IsTimerWheelValid(wheel, slots, tick))
+        return false;
+    EntityHandle handles[POWER_UP_COUNT + 2];
+    memcpy(handles, FindGameStateField(buffer, offsets, powerUpTimers), sizeof(powerUpTimers));
+    memcpy(&handles[POWER_UP_COUNT], FindGameStateField(buffer, offsets, &ufoTimer), sizeof(ufoTimer));
+    memcpy(&handles[POWER_UP_COUNT + 1], FindGameStateField(buffer, offsets, &reloadTimer), sizeof(reloadTimer));
+    for (int i = 0; i < POWER_UP_COUNT + 2; ++i)
+    {
+        if (handles[i] != nullHandle && GetHandleIndex(handles[i]) >= MAX_TIMER_COUNT)
+            return false;
+    }
+    return true;
 }
 
-void DrawBullets()
+bool IsTimerWheelValid(const Timer *wheel, const short *slots, unsigned int tick)
 {
-    for (int i = 0; i < MAX_BULLET_COUNT; ++i)
+    const int maxTicks = (1 << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVEL_COUNT)) - 1;
+    bool linked[MAX_TIMER_COUNT] = { false };
+    int linkedCount = 0;
+    for (int slot = 0; slot <= TIMER_WHEEL_LEVEL_COUNT * TIMER_WHEEL_SLOT_COUNT; ++slot)
     {
-        if (bullets[i].active)
+        const bool free = slot == TIMER_WHEEL_LEVEL_COUNT * TIMER_WHEEL_SLOT_COUNT;
+        int previous = -1;
+        for (int timer = slots[slot]; timer != -1; timer = wheel[timer].next)
         {
-            if (bullets[i].belongsToPlayer)
-            {
-                DrawCircleV(bullets[i].position, playerBulletRadius, playerBulletColor);
-            }
-            else
-            {
-                DrawCircleV(bullets[i].position, alienBulletRadius, alienBulletColor);
-            }
+            if (timer < 0 || timer >= MAX_TIMER_COUNT || linked[timer])
+                return false;
+            const Timer *entry = &wheel[timer];
+            if (free && entry->slot != -1)
+                return false;
+            if (!free && (entry->slot != slot || entry->previous != previous || entry->expiry - tick < 1 || entry->expiry - tick > (unsigned int)maxTicks))
+                return false;
+            if (!free && (entry->event > flashTimerEvent || (entry->event == powerUpTimerEvent && entry->payload >= POWER_UP_COUNT)))
+                return false;
+            linked[timer] = true;
+            ++linkedCount;
+            previous = timer;
         }
     }
+    return linkedCount == MAX_TIMER_COUNT;
+}
+
+const unsigned char *FindGameStateField(const unsigned char *buffer, const int *offsets, const void *data)
+{
+    int i = 0;
+    while (instanceFields[i].data != data)
+    {
+        ++i;
+    }
+    return buffer + offsets[i];
+}
+
+void SaveWaveSnapshot()
+{
+    if (waveSnapshots[activeInstance] == NULL)
+        waveSnapshots[activeInstance] = RL_MALLOC(GetGameStateSize());
+    SaveGameState(waveSnapshots[activeInstance]);
+}
+
+bool RestartWave()
+{
+    if (waveSnapshots[activeInstance] == NULL)
+        return false;
+    LoadGameState(waveSnapshots[activeInstance], GetGameStateSize());
+    return true;
+}
+
+void Draw()
+{
+    const double start = GetTimestamp();
+    CaptureFrame();
+    ReadScreenshots();
+    const bool screenshot = screenshotRequested && BeginReadbackTarget(&screenshotTargets);
+    if (!screenshot)
+        BeginDrawing();
+    ClearBackground(BLACK);
+    if (instanceCount == 1)
+    {
+        DrawGameState();
+    }
+    else
+    {
+        for (int i = instanceCount - 1; i >= 0; --i)
+        {
+            DrawInstance(i);
+        }
+    }
+    if (screenshot)
+    {
+        const Texture2D texture = screenshotTargets.targets[screenshotTargets.next].texture;
+        EndReadbackTarget(&screenshotTargets);
+        BeginDrawing();
+        DrawTextureRec(texture, (Rectangle) { 0, 0, screenWidth, -screenHeight }, Vector2Zero(), WHITE);
+        screenshotRequested = false;
+    }
+    drawNanoseconds = (GetTimestamp() - start) * 1e9;
+    if (drawNanoseconds > drawMaxNanoseconds)
+        drawMaxNanoseconds = drawNanoseconds;
+    EndDrawing();
+}
+
+void DrawInstance(int instance)
+{
+    SelectInstance(instance);
+    const int columns = 2;
+    const int rows = instanceCount > 2 ? 2 : 1;
+    const float viewportWidth = (float)screenWidth / columns;
+    const float viewportHeight = (float)screenHeight / rows;
+    const float scale = fminf(viewportWidth / screenWidth, viewportHeight / screenHeight);
+    const Vector2 origin = { (instance % columns) * viewportWidth + (viewportWidth - screenWidth * scale) * 0.5f, (instance / columns) * viewportHeight + (viewportHeight - screenHeight * scale) * 0.5f };
+    const Camera2D instanceCamera = camera;
+    camera.offset = (Vector2) { origin.x + camera.offset.x * scale, origin.y + camera.offset.y * scale };
+    camera.zoom *= scale;
+    BeginScissorMode(origin.x, origin.y, screenWidth * scale, screenHeight * scale);
+    rlPushMatrix();
+    rlTranslatef(origin.x, origin.y, 0);
+    rlScalef(scale, scale, 1);
+    DrawGameState();
+    rlPopMatrix();
+    EndScissorMode();
+    DrawRectangleLines(origin.x, origin.y, screenWidth * scale, screenHeight * scale, viewportBorderColor);
+    camera = instanceCamera;
+}
+
+void DrawGameState()
+{
+    gameStates[gameState].draw();
+    if (attractDemo != NULL)
+        DrawAttractOverlay();
+}
+
+void Terminate()
+{
+    EndReplayRecording();
+    CloseReplay();
+    CloseAutomation();
+    UnloadBot();
+    CloseCapture();
+    StopCapture();
+    StopScreenshotWriter();
+    StopHighScoreWriter();
+    UnloadMusicStream(music);
+    mixerReady = false;
+    UnloadAudioStream(mixerStream);
+    for (int i = 0; i < SOUND_EFFECT_COUNT; ++i)
+    {
+        RL_FREE(soundEffectSamples[i]);
+    }
+    for (int i = 0; i < MAX_INSTANCE_COUNT; ++i)
+    {
+        RL_FREE(instanceStates[i]);
+        RL_FREE(waveSnapshots[i]);
+    }
+    UnloadTexture(playerTexture);
+    UnloadTexture(alienTexture);
+    UnloadTexture(ufoTexture);
+    UnloadShader(alienShader);
+    CloseAudioDevice();
+    CloseWindow();
+}
+
+void ChangeGameState(GameState state)
+{
+    if (gameStates[gameState].exit != NULL)
+        gameStates[gameState].exit();
+    gameState = state;
+    if (gameStates[gameState].enter != NULL)
+        gameStates[gameState].enter();
+}
+
+void EnterStartState()
+{
+    livesRemaining = 3;
+    score = 0;
+    homingMissilesRemaining = 0;
+    wave = 1;
+}
+
+void EnterReadyState()
+{
+    ScheduleTimer(readyTimerEvent, SecondsToTicks(delayThreshold), nullHandle, 0);
+    playerPositions[0] = (Vector2) { screenHalfWidth - playerHalfWidth, screenHalfHeight - playerHalfHeight };
+}
+
+void EnterPlayState()
+{
+    ufoTimer = ScheduleTimer(ufoTimerEvent, SecondsToTicks(RandomValue(ufoMinSpawnSeconds, ufoMaxSpawnSeconds)), nullHandle, 0);
+    while (preloadedAlienRows < GetWaveRowCount(wave))
+    {
+        PreloadPlayState();
+    }
+    preloadedAlienRows = 0;
+    SteerFormationSystem();
+    UpdateFormationExtents();
+    waveSnapshotPending = true;
+}
+
+void ExitPlayState()
+{
+    CancelTimer(ufoTimer);
+    ClearArchetype(playerBulletArchetype);
+    ClearArchetype(alienBulletArchetype);
+    ClearArchetype(ufoArchetype);
+    ClearArchetype(emitterArchetype);
+    ClearArchetype(dropArchetype);
+}
+
+void EnterWinState()
+{
+    ScheduleTimer(winTimerEvent, SecondsToTicks(delayThreshold), nullHandle, 0);
+}
+
+void ExitWinState()
+{
+    ++wave;
+}
+
+void EnterLoseState()
+{
+    ScheduleTimer(loseTimerEvent, SecondsToTicks(delayThreshold), nullHandle, 0);
+    playerAlive[0] = false;
+    ClearPowerUps();
+}
+
+void ExitLoseState()
+{
+    formationLanded = false;
+    playerPositions[0] = (Vector2) { screenHalfWidth - playerHalfWidth, screenHalfHeight - playerHalfHeight };
+    playerAlive[0] = true;
+    ClearArchetype(alienArchetype);
+    alienCount = 0;
+}
+
+void PreloadReadyState()
+{
+    GetWaveText(wave);
+    GetWaveText(wave + 1);
+}
+
+void PreloadPlayState()
+{
+    const int rows = GetWaveRowCount(wave);
+    if (preloadedAlienRows >= rows)
+        return;
+    const int row = preloadedAlienRows++;
+    for (int column = -7; column <= 7; ++column)
+    {
+        const int alien = SpawnEntity(alienArchetype);
+        if (alien < 0)
+            break;
+        alienPositions[alien] = (Vector2) { camera.target.x - column * (alienWidth + alienHalfWidth), cameraBounds.y + 10 + (alienHeight + alienHalfHeight) * (row + 1) };
+        alienTypeIds[alien] = alienRowTypes[rows - 1 - row];
+        alienHitPoints[alien] = alienTypes[alienTypeIds[alien]].hitPoints;
+        alienHitFlashes[alien] = false;
+        alienPhases[alien] = (column + 7) * 17;
+        ++alienCount;
+    }
+}
+
+const WaveText *GetWaveText(int waveNumber)
+{
+    WaveText *text = &waveTexts[activeInstance][waveNumber % 2];
+    if (text->wave != waveNumber)
+    {
+        text->wave = waveNumber;
+        sprintf(text->readyText, "Ready Wave %d!", waveNumber);
+        text->readyHalfWidth = MeasureText(text->readyText, textSize) * 0.5;
+        sprintf(text->completeText, "Wave %d Complete!", waveNumber);
+        text->completeHalfWidth = MeasureText(text->completeText, textSize) * 0.5;
+        sprintf(text->shelfText, "Wave: %d", waveNumber);
+        text->shelfWidth = MeasureText(text->shelfText, textSize);
+    }
+    return text;
+}
+
+void DrawStartState()
+{
+    const int startHalfWidth = MeasureText("Press SHOOT To Play!", textSize) * 0.5;
+    DrawText("Press SHOOT To Play!", screenHalfWidth - startHalfWidth, 40, textSize, WHITE);
+    for (int i = 0; i < highScoreCount && i < highScoreDisplayCount; ++i)
+    {
+        char highScoreBuffer[40];
+        sprintf(highScoreBuffer, "%d. %u (Wave %u)", i + 1, highScores[i].score, highScores[i].wave);
+        const int highScoreHalfWidth = MeasureText(highScoreBuffer, textSize) * 0.5;
+        DrawText(highScoreBuffer, screenHalfWidth - highScoreHalfWidth, 80 + i * (textSize + 10), textSize, i == 0 ? GOLD : LIGHTGRAY);
+    }
+    DrawWorld();
+}
+
+void DrawReadyState()
+{
+    const WaveText *text = GetWaveText(wave);
+    DrawText(text->readyText, screenHalfWidth - text->readyHalfWidth, 40, textSize, WHITE);
+    if (wave >= 19)
+    {
+        const int maxHalfWidth = MeasureText("Maximum Difficulty", textSize) * 0.5;
+        DrawText("Maximum Difficulty", screenHalfWidth - maxHalfWidth, 80, textSize, RED);
+    }
+    DrawBottomShelf();
+    DrawWorld();
+}
+
+void DrawPlayState()
+{
+    DrawBottomShelf();
+    DrawWorld();
+}
+
+void DrawWinState()
+{
+    const WaveText *text = GetWaveText(wave);
+    DrawText(text->completeText, screenHalfWidth - text->completeHalfWidth, 40, textSize, WHITE);
+    DrawBottomShelf();
+    DrawWorld();
+}
+
+void DrawLoseState()
+{
+    const char *loseText = formationLanded ? "The aliens have landed!" : "You died!";
+    const int loseHalfWidth = MeasureText(loseText, textSize) * 0.5;
+    DrawText(loseText, screenHalfWidth - loseHalfWidth, 40, textSize, WHITE);
+    DrawBottomShelf();
+    DrawWorld();
+}
+
+void DrawBottomShelf()
+{
+    char livesBuffer[9];
+    sprintf(livesBuffer, "Lives: %d", livesRemaining);
+    DrawText(livesBuffer, 20, screenHeight - textSize - 20, textSize, WHITE);
+    if (homingMissilesRemaining > 0)
+    {
+        char missilesBuffer[22];
+        sprintf(missilesBuffer, "Missiles: %d", homingMissilesRemaining);
+        DrawText(missilesBuffer, 20, screenHeight - textSize * 2 - 30, textSize, playerMissileColor);
+    }
+    const WaveText *text = GetWaveText(wave);
+    DrawText(text->shelfText, screenWidth - text->shelfWidth - 20, screenHeight - textSize - 20, textSize, WHITE);
+    int powerUpY = screenHeight - textSize * 2 - 30;
+    for (int i = 0; i < POWER_UP_COUNT; ++i)
+    {
+        if (!powerUpActive[i])
+            continue;
+        const int powerUpWidth = MeasureText(powerUps[i].name, textSize);
+        DrawText(powerUps[i].name, screenWidth - powerUpWidth - 20, powerUpY, textSize, powerUps[i].color);
+        powerUpY -= textSize + 10;
+    }
+    char scoreBuffer[18];
+    sprintf(scoreBuffer, "Score: %d", score);
+    const int scoreHalfWidth = MeasureText(scoreBuffer, textSize) * 0.5;
+    DrawText(scoreBuffer, screenHalfWidth - scoreHalfWidth, screenHeight - textSize - 20, textSize, WHITE);
+}
+
+void DrawWorld()
+{
+    BeginMode2D(camera);
+    DrawSpriteSystem();
+    DrawHitFlashes();
+    DrawCircleSystem();
+    if (powerUpActive[shieldPowerUp])
+        DrawShield();
+    if (gameState == loseState)
+        DrawKillerHighlight();
+    EndMode2D();
+}
+
+void DrawShield()
+{
+    DrawCircleLines(playerPositions[0].x + playerHalfWidth, playerPositions[0].y + playerHalfHeight, playerWidth, shieldColor);
+}
+
+void DrawKillerHighlight()
+{
+    if (IsEntityHandleValid(alienArchetype, playerKiller))
+    {
+        const int alien = GetHandleIndex(playerKiller);
+        const float animationTime = GetAnimationTime();
+        const bool shaded = BeginAnimationShader(&archetypes[alienArchetype], animationTime);
+        const int frame = shaded ? 0 : GetAnimationFrame(animationTime, alienPhases[alien], archetypes[alienArchetype].frameCount);
+        DrawTextureRec(alienTexture, (Rectangle) { frame * alienWidth, alienTypeIds[alien] * alienHeight, alienWidth, alienHeight }, alienPositions[alien], shaded ? (Color) { RED.r, RED.g, RED.b, alienPhases[alien] } : RED);
+        if (shaded)
+            EndShaderMode();
+    }
+}
+
+void DrawHitFlashes()
+{
+    const float animationTime = GetAnimationTime();
+    BeginBlendMode(BLEND_ADDITIVE);
+    for (int i = 0; i < alienExtent; ++i)
+    {
+        if (alienAlive[i] && alienHitFlashes[i])
+        {
+            const int frame = GetAnimationFrame(animationTime, alienPhases[i], archetypes[alienArchetype].frameCount);
+            DrawTextureRec(alienTexture, (Rectangle) { frame * alienWidth, alienTypeIds[i] * alienHeight, alienWidth, alienHeight }, alienPositions[i], WHITE);
+        }
+    }
+    EndBlendMode();
 }
 
 void UpdateStartState()
 {
-    if (IsKeyDown(KEY_ENTER))
-    {
-        FromStartToReadyState();
-    }
+    if (input & shootHeldInput)
+    {
+        ChangeGameState(readyState);
+    }
+}
+
+void UpdatePlayState()
+{
+    if (waveSnapshotPending)
+    {
+        waveSnapshotPending = false;
+        SaveWaveSnapshot();
+    }
+    if (input & leftInput)
+    {
+        playerPositions[0].x -= playerSpeed;
+        if (playerPositions[0].x < cameraBounds.x)
+        {
+            playerPositions[0].x = cameraBounds.x;
+        }
+    }
+    if (input & rightInput)
+    {
+        playerPositions[0].x += playerSpeed;
+        if (playerPositions[0].x > cameraBounds.x + cameraBounds.width - playerWidth)
+        {
+            playerPositions[0].x = cameraBounds.x + cameraBounds.width - playerWidth;
+        }
+    }
+    if (!playerReloading && ((input & shootInput) || (powerUpActive[rapidFirePowerUp] && (input & shootHeldInput))))
+    {
+        ShootPlayerBullet();
+    }
+    slowTimeSkip = powerUpActive[slowTimePowerUp] && !slowTimeSkip;
+    if (!slowTimeSkip)
+    {
+        IntegrateSystem(alienArchetype);
+        if (MarchFormationSystem())
+        {
+            return;
+        }
+        FireAlienSystem();
+        RunEmitterSystem();
+        FollowPathSystem();
+        HomingSystem();
+        OscillateSystem(alienBulletArchetype);
+        IntegrateSystem(playerBulletArchetype);
+        IntegrateSystem(alienBulletArchetype);
+    }
+    else
+    {
+        HomingSystem();
+        IntegrateSystem(playerBulletArchetype);
+    }
+    IntegrateSystem(dropArchetype);
+    if (UpdateCollisionSystem())
+    {
+        return;
+    }
+    CullSystem();
+}
+
+void ClearTimers()
+{
+    for (int slot = 0; slot < TIMER_WHEEL_LEVEL_COUNT * TIMER_WHEEL_SLOT_COUNT; ++slot)
+    {
+        timerSlots[slot] = -1;
+    }
+    for (int i = 0; i < MAX_TIMER_COUNT; ++i)
+    {
+        timers[i].slot = -1;
+        timers[i].next = i + 1 < MAX_TIMER_COUNT ? i + 1 : -1;
+    }
+    freeTimer = 0;
+    timerTick = 0;
+    timerClock = 0;
+}
+
+void AdvanceTimers()
+{
+    timerClock += frameTime;
+    while (timerClock >= tickTime)
+    {
+        timerClock -= tickTime;
+        AdvanceTimerWheel();
+    }
+}
+
+void AdvanceTimerWheel()
+{
+    ++timerTick;
+    for (int level = TIMER_WHEEL_LEVEL_COUNT - 1; level > 0; --level)
+    {
+        const int shift = TIMER_WHEEL_SLOT_BITS * level;
+        if ((timerTick & ((1u << shift) - 1)) != 0)
+            continue;
+        const int slot = level * TIMER_WHEEL_SLOT_COUNT + ((timerTick >> shift) & (TIMER_WHEEL_SLOT_COUNT - 1));
+        while (timerSlots[slot] >= 0)
+        {
+            const int timer = timerSlots[slot];
+            UnlinkTimer(timer);
+            InsertTimer(timer);
+        }
+    }
+    const int slot = timerTick & (TIMER_WHEEL_SLOT_COUNT - 1);
+    while (timerSlots[slot] >= 0)
+    {
+        const int timer = timerSlots[slot];
+        UnlinkTimer(timer);
+        timers[timer].next = freeTimer;
+        freeTimer = timer;
+        HandleTimer(timers[timer].event, timers[timer].argument, timers[timer].payload);
+    }
+}
+
+EntityHandle ScheduleTimer(TimerEvent event, int ticks, EntityHandle argument, unsigned char payload)
+{
+    if (freeTimer < 0)
+        return nullHandle;
+    const int maxTicks = (1 << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVEL_COUNT)) - 1;
+    const int timer = freeTimer;
+    freeTimer = timers[timer].next;
+    timers[timer].expiry = timerTick + Clamp(ticks, 1, maxTicks);
+    timers[timer].generation = NextGeneration(timers[timer].generation);
+    timers[timer].event = event;
+    timers[timer].argument = argument;
+    timers[timer].payload = payload;
+    InsertTimer(timer);
+    return MakeHandle(timer, timers[timer].generation);
+}
+
+void CancelTimer(EntityHandle handle)
+{
+    const int timer = GetHandleIndex(handle);
+    if (handle == nullHandle || timers[timer].slot < 0 || timers[timer].generation != GetHandleGeneration(handle))
+        return;
+    UnlinkTimer(timer);
+    timers[timer].next = freeTimer;
+    freeTimer = timer;
+}
+
+void InsertTimer(int timer)
+{
+    const unsigned int expiry = timers[timer].expiry;
+    const unsigned int delta = expiry - timerTick;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVEL_COUNT - 1 && delta >= 1u << (TIMER_WHEEL_SLOT_BITS * (level + 1)))
+    {
+        ++level;
+    }
+    const int slot = level * TIMER_WHEEL_SLOT_COUNT + ((expiry >> (TIMER_WHEEL_SLOT_BITS * level)) & (TIMER_WHEEL_SLOT_COUNT - 1));
+    timers[timer].slot = slot;
+    timers[timer].previous = -1;
+    timers[timer].next = timerSlots[slot];
+    if (timerSlots[slot] >= 0)
+        timers[timerSlots[slot]].previous = timer;
+    timerSlots[slot] = timer;
+}
+
+void UnlinkTimer(int timer)
+{
+    const int previous = timers[timer].previous;
+    const int next = timers[timer].next;
+    if (previous >= 0)
+        timers[previous].next = next;
+    else
+        timerSlots[timers[timer].slot] = next;
+    if (next >= 0)
+        timers[next].previous = previous;
+    timers[timer].slot = -1;
+}
+
+void HandleTimer(TimerEvent event, EntityHandle argument, unsigned char payload)
+{
+    switch (event)
+    {
+        case readyTimerEvent:
+            ChangeGameState(playState);
+            break;
+        case winTimerEvent:
+            ChangeGameState(readyState);
+            break;
+        case loseTimerEvent:
+            if (livesRemaining > 1 && !formationLanded)
+            {
+                --livesRemaining;
+                ChangeGameState(readyState);
+            }
+            else
+            {
+                if (attractDemo == NULL)
+                    SubmitHighScore(score, wave);
+                ChangeGameState(startState);
+            }
+            break;
+        case ufoTimerEvent:
+            SpawnUfo();
+            break;
+        case dropTimerEvent:
+            if (IsEntityHandleValid(dropArchetype, argument))
+                DespawnEntity(dropArchetype, GetHandleIndex(argument));
+            break;
+        case powerUpTimerEvent:
+            powerUpActive[payload] = false;
+            powerUpTimers[payload] = nullHandle;
+            break;
+        case reloadTimerEvent:
+            reloadTimer = nullHandle;
+            playerReloading = false;
+            break;
+        case flashTimerEvent:
+            if (IsEntityHandleValid(alienArchetype, argument))
+                alienHitFlashes[GetHandleIndex(argument)] = false;
+            break;
+    }
+}
+
+int SecondsToTicks(float seconds)
+{
+    return (int)(seconds / tickTime + 0.5f);
+}
+
+void SpawnDrop(Vector2 position)
+{
+    const int drop = SpawnEntity(dropArchetype);
+    if (drop < 0)
+        return;
+    dropPositions[drop] = position;
+    dropVelocities[drop] = (Vector2) { 0, dropSpeed };
+    dropKinds[drop] = RandomValue(0, POWER_UP_COUNT - 1);
+    dropRadii[drop] = dropRadius;
+    dropColors[drop] = powerUps[dropKinds[drop]].color;
+    ScheduleTimer(dropTimerEvent, SecondsToTicks(dropLifetime), GetEntityHandle(dropArchetype, drop), 0);
+}
+
+void ActivatePowerUp(PowerUpId powerUp)
+{
+    CancelTimer(powerUpTimers[powerUp]);
+    powerUpActive[powerUp] = true;
+    powerUpTimers[powerUp] = ScheduleTimer(powerUpTimerEvent, SecondsToTicks(powerUps[powerUp].seconds), nullHandle, powerUp);
+}
+
+void ClearPowerUps()
+{
+    for (int i = 0; i < POWER_UP_COUNT; ++i)
+    {
+        CancelTimer(powerUpTimers[i]);
+        powerUpTimers[i] = nullHandle;
+        powerUpActive[i] = false;
+    }
+    CancelTimer(reloadTimer);
+    reloadTimer = nullHandle;
+    playerReloading = false;
+}
+
+void BuildUfoPaths()
+{
+    static Vector2 points[(UFO_WAYPOINT_COUNT - 1) * UFO_PATH_SUBDIVISION_COUNT + 1];
+    static float lengths[(UFO_WAYPOINT_COUNT - 1) * UFO_PATH_SUBDIVISION_COUNT + 1];
+    for (int pattern = 0; pattern < UFO_PATTERN_COUNT; ++pattern)
+    {
+        const Vector2 *waypoints = ufoWaypoints[pattern];
+        int pointCount = 0;
+        for (int segment = 0; segment < UFO_WAYPOINT_COUNT - 1; ++segment)
+        {
+            const Vector2 p0 = waypoints[segment > 0 ? segment - 1 : 0];
+            const Vector2 p3 = waypoints[segment + 2 < UFO_WAYPOINT_COUNT ? segment + 2 : UFO_WAYPOINT_COUNT - 1];
+            for (int step = 0; step < UFO_PATH_SUBDIVISION_COUNT; ++step)
+            {
+                points[pointCount++] = GetCatmullRomPoint(p0, waypoints[segment], waypoints[segment + 1], p3, (float)step / UFO_PATH_SUBDIVISION_COUNT);
+            }
+        }
+        points[pointCount++] = waypoints[UFO_WAYPOINT_COUNT - 1];
+        lengths[0] = 0;
+        for (int i = 1; i < pointCount; ++i)
+        {
+            lengths[i] = lengths[i - 1] + Vector2Distance(points[i - 1], points[i]);
+        }
+        Vector2 *path = ufoPathPoints[pattern * 2];
+        Vector2 *mirroredPath = ufoPathPoints[pattern * 2 + 1];
+        const float mirrorX = waypoints[0].x + waypoints[UFO_WAYPOINT_COUNT - 1].x;
+        int sampleCount = 0;
+        int point = 1;
+        while (sampleCount < MAX_UFO_PATH_SAMPLE_COUNT && sampleCount * ufoSpeed <= lengths[pointCount - 1])
+        {
+            const float distance = sampleCount * ufoSpeed;
+            while (point < pointCount - 1 && lengths[point] < distance)
+            {
+                ++point;
+            }
+            const float segmentLength = lengths[point] - lengths[point - 1];
+            path[sampleCount] = Vector2Lerp(points[point - 1], points[point], segmentLength > 0 ? (distance - lengths[point - 1]) / segmentLength : 0);
+            mirroredPath[sampleCount] = (Vector2) { mirrorX - path[sampleCount].x, path[sampleCount].y };
+            ++sampleCount;
+        }
+        ufoPathSampleCounts[pattern * 2] = sampleCount;
+        ufoPathSampleCounts[pattern * 2 + 1] = sampleCount;
+    }
+}
+
+Vector2 GetCatmullRomPoint(Vector2 p0, Vector2 p1, Vector2 p2, Vector2 p3, float t)
+{
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    return (Vector2) {
+        0.5f * (2 * p1.x + (p2.x - p0.x) * t + (2 * p0.x - 5 * p1.x + 4 * p2.x - p3.x) * t2 + (3 * p1.x - p0.x - 3 * p2.x + p3.x) * t3),
+        0.5f * (2 * p1.y + (p2.y - p0.y) * t + (2 * p0.y - 5 * p1.y + 4 * p2.y - p3.y) * t2 + (3 * p1.y - p0.y - 3 * p2.y + p3.y) * t3)
+    };
+}
+
+void ShootPlayerBullet()
+{
+    const bool homing = homingMissilesRemaining > 0;
+    if (homing)
+        --homingMissilesRemaining;
+    const int shotCount = powerUpActive[multiShotPowerUp] ? multiShotCount : 1;
+    for (int shot = 0; shot < shotCount; ++shot)
+    {
+        const int bullet = SpawnEntity(playerBulletArchetype);
+        if (bullet < 0)
+            break;
+        playerBulletPositions[bullet] = (Vector2) { playerPositions[0].x + playerHalfWidth, playerPositions[0].y - playerBulletRadius };
+        playerBulletVelocities[bullet] = (Vector2) { (shot - (shotCount - 1) * 0.5f) * multiShotSpread, -playerBulletSpeed };
+        playerBulletHomingRates[bullet] = homing ? playerMissileHoming : 0;
+        playerBulletRadii[bullet] = playerBulletRadius;
+        playerBulletColors[bullet] = homing ? playerMissileColor : playerBulletColor;
+    }
+    if (powerUpActive[rapidFirePowerUp])
+    {
+        CancelTimer(reloadTimer);
+        playerReloading = true;
+        reloadTimer = ScheduleTimer(reloadTimerEvent, rapidFireTicks, nullHandle, 0);
+    }
+    PlaySoundEffect(shootSoundEffect, playerPositions[0].x + playerHalfWidth);
+}
+
+void ShootAlienBullet(int alienIndex)
+{
+    const int emitter = SpawnEntity(emitterArchetype);
+    if (emitter < 0)
+        return;
+    emitterOwners[emitter] = GetEntityHandle(alienArchetype, alienIndex);
+    emitterStates[emitter] = (BulletEmitter) { alienTypes[alienTypeIds[alienIndex]].pattern, 0, 0, 0, 0, 0, 0, 0, 0, alienBulletSpeed };
+}
+
+void ShootPatternBullet(const BulletEmitter *emitter, Vector2 position, float angle, EntityHandle owner)
+{
+    const Vector2 direction = { sinf(angle * DEG2RAD), cosf(angle * DEG2RAD) };
+    const int bullet = SpawnEntity(alienBulletArchetype);
+    if (bullet < 0)
+        return;
+    alienBulletPositions[bullet] = position;
+    alienBulletVelocities[bullet] = Vector2Scale(direction, emitter->speed);
+    alienBulletAnchors[bullet] = position;
+    alienBulletDrifts[bullet] = alienBulletVelocities[bullet];
+    alienBulletHomingRates[bullet] = emitter->homing * 0.01f;
+    if (emitter->wavePeriod > 0)
+    {
+        const float frequency = 2 * PI / emitter->wavePeriod;
+        alienBulletSprings[bullet] = (Vector2) { frequency * frequency, frequency * frequency };
+        alienBulletVelocities[bullet] = Vector2Add(alienBulletVelocities[bullet], Vector2Scale((Vector2) { direction.y, -direction.x }, emitter->waveAmplitude * frequency));
+    }
+    alienBulletRadii[bullet] = alienBulletRadius;
+    alienBulletColors[bullet] = alienBulletColor;
+    alienBulletOwners[bullet] = owner;
+}
+
+bool BuildBulletPatterns()
+{
+    bool valid = true;
+    for (int i = 0; i < BULLET_PATTERN_COUNT; ++i)
+    {
+        if (!CompileBulletPattern(bulletPatternSources[i], bulletPatternCode[i], MAX_BULLET_PATTERN_SIZE))
+        {
+            fprintf(stderr, "bullet pattern %d: could not compile \"%s\"\n", i, bulletPatternSources[i]);
+            bulletPatternCode[i][0] = haltOpcode;
+            valid = false;
+        }
+    }
+    return valid;
+}
+
+bool CompileBulletPattern(const char *source, unsigned char *code, int codeSize)
+{
+    int size = 0;
+    int repeatStart = -1;
+    int length = 0;
+    char word[16];
+    while (sscanf(source, " %15[a-z]%n", word, &length) == 1)
+    {
+        source += length;
+        int opcode = 0;
+        while (opcode < BULLET_OPCODE_COUNT && strcmp(word, bulletOpcodeNames[opcode]) != 0)
+        {
+            ++opcode;
+        }
+        if (opcode == BULLET_OPCODE_COUNT || size + 1 + bulletOpcodeOperandCounts[opcode] >= codeSize)
+            return false;
+        if ((opcode == repeatOpcode && repeatStart >= 0) || (opcode == endOpcode && repeatStart < 0))
+            return false;
+        repeatStart = opcode == repeatOpcode ? size : opcode == endOpcode ? -1 : repeatStart;
+        code[size++] = opcode;
+        for (int i = 0; i < bulletOpcodeOperandCounts[opcode]; ++i)
+        {
+            int operand = 0;
+            if (sscanf(source, " %d%n", &operand, &length) != 1 || operand < (opcode == angleOpcode ? -128 : 0) || operand > (opcode == angleOpcode ? 127 : 255))
+                return false;
+            source += length;
+            code[size++] = (unsigned char)operand;
+        }
+    }
+    while (*source == ' ' || *source == '\n' || *source == '\t')
+    {
+        ++source;
+    }
+    code[size] = haltOpcode;
+    return *source == '\0' && repeatStart < 0;
+}
+
+bool IsBulletPatternOffsetValid(int pattern, int offset)
+{
+    const unsigned char *code = bulletPatternCode[pattern];
+    int programCounter = 0;
+    while (programCounter < offset && code[programCounter] != haltOpcode)
+    {
+        programCounter += 1 + bulletOpcodeOperandCounts[code[programCounter]];
+    }
+    return programCounter == offset;
+}
+
+int SpawnEntity(ArchetypeId archetype)
+{
+    const Archetype *type = &archetypes[archetype];
+    int index = *type->nextAvailable;
+    while (index < type->capacity && type->alive[index])
+    {
+        ++index;
+    }
+    if (index == type->capacity)
+        return -1;
+    type->alive[index] = true;
+    type->generations[index] = NextGeneration(type->generations[index]);
+    if (type->components & velocityComponent)
+        type->velocities[index] = (Vector2) { 0, 0 };
+    if (type->components & oscillatorComponent)
+        type->springs[index] = (Vector2) { 0, 0 };
+    *type->nextAvailable = index + 1;
+    if (index >= *type->extent)
+        *type->extent = index + 1;
+    return index;
+}
+
+void DespawnEntity(ArchetypeId archetype, int index)
+{
+    const Archetype *type = &archetypes[archetype];
+    type->alive[index] = false;
+    if (type->components & velocityComponent)
+        type->velocities[index] = (Vector2) { 0, 0 };
+    if (type->components & oscillatorComponent)
+        type->springs[index] = (Vector2) { 0, 0 };
+    if (index < *type->nextAvailable)
+        *type->nextAvailable = index;
+    while (*type->extent > 0 && !type->alive[*type->extent - 1])
+    {
+        --*type->extent;
+    }
+}
+
+void ClearArchetype(ArchetypeId archetype)
+{
+    for (int i = 0; i < archetypes[archetype].capacity; ++i)
+    {
+        DespawnEntity(archetype, i);
+    }
+}
+
+int CountEntities(ArchetypeId archetype)
+{
+    int count = 0;
+    for (int i = 0; i < *archetypes[archetype].extent; ++i)
+    {
+        count += archetypes[archetype].alive[i];
+    }
+    return count;
+}
+
+void SteerFormationSystem()
+{
+    const float speed = alienDirection == 0 ? alienSpeed : -alienSpeed;
+    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+    {
+        alienVelocities[i].x = speed * alienAlive[i];
+    }
+}
+
+void UpdateFormationExtents()
+{
+    formationLeft = cameraBounds.x + cameraBounds.width;
+    formationRight = cameraBounds.x;
+    formationBottom = cameraBounds.y;
+    for (int i = 0; i < alienExtent; ++i)
+    {
+        if (alienAlive[i])
+        {
+            formationLeft = fminf(formationLeft, alienPositions[i].x);
+            formationRight = fmaxf(formationRight, alienPositions[i].x + alienWidth);
+            formationBottom = fmaxf(formationBottom, alienPositions[i].y + alienHeight);
+        }
+    }
+}
+
+bool MarchFormationSystem()
+{
+    const float speed = alienDirection == 0 ? alienSpeed : -alienSpeed;
+    formationLeft += speed;
+    formationRight += speed;
+    if ((alienDirection == 0 && formationRight > cameraBounds.x + cameraBounds.width) || (alienDirection == 1 && formationLeft < cameraBounds.x))
+    {
+        alienDirection = !alienDirection;
+        SteerFormationSystem();
+        for (int i = 0; i < alienExtent; ++i)
+        {
+            alienPositions[i].y += alienStepDown;
+        }
+        formationBottom += alienStepDown;
+        if (formationBottom > playerPositions[0].y)
+        {
+            formationLanded = true;
+            playerKiller = nullHandle;
+            PlaySoundEffect(playerDeathSoundEffect, playerPositions[0].x + playerHalfWidth);
+            ChangeGameState(loseState);
+            return true;
+        }
+    }
+    return false;
+}
+
+void FireAlienSystem()
+{
+    int fireOdds[ALIEN_TYPE_COUNT];
+    for (int t = 0; t < ALIEN_TYPE_COUNT; ++t)
+    {
+        fireOdds[t] = GetWaveFireOdds(wave) * 100 / alienTypes[t].fireRate;
+    }
+    for (int i = 0; i < alienExtent; ++i)
+    {
+        if (alienAlive[i] && RandomValue(1, fireOdds[alienTypeIds[i]]) == 1)
+        {
+            ShootAlienBullet(i);
+        }
+    }
+}
+
+void SpawnUfo()
+{
+    ufoTimer = ScheduleTimer(ufoTimerEvent, SecondsToTicks(RandomValue(ufoMinSpawnSeconds, ufoMaxSpawnSeconds)), nullHandle, 0);
+    const int ufo = SpawnEntity(ufoArchetype);
+    if (ufo < 0)
+        return;
+    if (ufo < 0)
+        return;
+    ufoPaths[ufo] = RandomValue(0, UFO_PATH_COUNT - 1);
+    ufoPathTicks[ufo] = -1;
+}
+
+void FollowPathSystem()
+{
+    for (int a = 0; a < ARCHETYPE_COUNT; ++a)
+    {
+        const Archetype *type = &archetypes[a];
+        if (!(type->components & pathComponent))
+            continue;
+        for (int i = 0; i < *type->extent; ++i)
+        {
+            if (!type->alive[i])
+                continue;
+            const int path = type->paths[i];
+            const int tick = ++type->pathTicks[i];
+            if (tick >= ufoPathSampleCounts[path])
+            {
+                DespawnEntity(a, i);
+                continue;
+            }
+            type->positions[i] = (Vector2) { cameraBounds.x + ufoPathPoints[path][tick].x, cameraBounds.y + ufoPathPoints[path][tick].y };
+        }
+    }
+}
+
+void RunEmitterSystem()
+{
+    const Vector2 target = { playerPositions[0].x + playerHalfWidth, playerPositions[0].y + playerHalfHeight };
+    for (int i = 0; i < emitterExtent; ++i)
+    {
+        if (!emitterAlive[i])
+            continue;
+        if (!IsEntityHandleValid(alienArchetype, emitterOwners[i]))
+        {
+            DespawnEntity(emitterArchetype, i);
+            continue;
+        }
+        BulletEmitter *emitter = &emitterStates[i];
+        if (emitter->waitTicks > 0 && --emitter->waitTicks > 0)
+            continue;
+        const int owner = GetHandleIndex(emitterOwners[i]);
+        const Vector2 muzzle = { alienPositions[owner].x + alienHalfWidth, alienPositions[owner].y + alienWidth + alienBulletRadius };
+        const unsigned char *code = bulletPatternCode[emitter->pattern];
+        bool running = true;
+        while (running)
+        {
+            const unsigned char opcode = code[emitter->programCounter++];
+            const unsigned char *operands = code + emitter->programCounter;
+            emitter->programCounter += opcode < BULLET_OPCODE_COUNT ? bulletOpcodeOperandCounts[opcode] : 0;
+            switch (opcode)
+            {
+                case speedOpcode:
+                    emitter->speed = operands[0] * 0.1f;
+                    break;
+                case angleOpcode:
+                    emitter->angle = (signed char)operands[0];
+                    break;
+                case aimOpcode:
+                    emitter->angle = atan2f(target.x - muzzle.x, target.y - muzzle.y) * RAD2DEG;
+                    break;
+                case waveOpcode:
+                    emitter->waveAmplitude = operands[0];
+                    emitter->wavePeriod = operands[1];
+                    break;
+                case fireOpcode:
+                    ShootPatternBullet(emitter, muzzle, emitter->angle, emitterOwners[i]);
+                    PlaySoundEffect(shootSoundEffect, muzzle.x);
+                    break;
+                case spreadOpcode:
+                    for (int shot = 0; shot < operands[0]; ++shot)
+                    {
+                        ShootPatternBullet(emitter, muzzle, emitter->angle + (shot - (operands[0] - 1) * 0.5f) * operands[1], emitterOwners[i]);
+                    }
+                    PlaySoundEffect(shootSoundEffect, muzzle.x);
+                    break;
+                case waitOpcode:
+                    emitter->waitTicks = operands[0];
+                    running = emitter->waitTicks == 0;
+                    break;
+                case repeatOpcode:
+                    emitter->repeatCount = operands[0];
+                    emitter->repeatStart = emitter->programCounter;
+                    while (emitter->repeatCount == 0 && code[emitter->programCounter] != endOpcode)
+                    {
+                        emitter->programCounter += 1 + bulletOpcodeOperandCounts[code[emitter->programCounter]];
+                    }
+                    break;
+                case endOpcode:
+                    if (emitter->repeatCount > 1)
+                    {
+                        --emitter->repeatCount;
+                        emitter->programCounter = emitter->repeatStart;
+                    }
+                    break;
+                case homeOpcode:
+                    emitter->homing = operands[0];
+                    break;
+                default:
+                    DespawnEntity(emitterArchetype, i);
+                    running = false;
+                    break;
+            }
+        }
+    }
+}
+
+void OscillateSystem(ArchetypeId archetype)
+{
+    const Archetype *type = &archetypes[archetype];
+    if (!(type->components & oscillatorComponent))
+        return;
+    const float *restrict positions = (const float *)type->positions;
+    float *restrict velocities = (float *)type->velocities;
+    float *restrict anchors = (float *)type->anchors;
+    const float *restrict drifts = (const float *)type->drifts;
+    const float *restrict springs = (const float *)type->springs;
+    const int count = *type->extent * 2;
+    int i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 anchor = _mm_loadu_ps(anchors + i);
+        _mm_storeu_ps(velocities + i, _mm_add_ps(_mm_loadu_ps(velocities + i), _mm_mul_ps(_mm_loadu_ps(springs + i), _mm_sub_ps(anchor, _mm_loadu_ps(positions + i)))));
+        _mm_storeu_ps(anchors + i, _mm_add_ps(anchor, _mm_loadu_ps(drifts + i)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        velocities[i] += springs[i] * (anchors[i] - positions[i]);
+        anchors[i] += drifts[i];
+    }
+}
+
+void HomingSystem()
+{
+    const Vector2 playerCenter = { playerPositions[0].x + playerHalfWidth, playerPositions[0].y + playerHalfHeight };
+    bool gridBuilt = false;
+    for (int i = 0; i < playerBulletExtent; ++i)
+    {
+        if (!playerBulletAlive[i] || playerBulletHomingRates[i] == 0)
+            continue;
+        if (!gridBuilt)
+        {
+            BuildHomingGrid();
+            gridBuilt = true;
+        }
+        const int alien = FindNearestAlien(playerBulletPositions[i]);
+        if (alien < 0)
+            continue;
+        const Vector2 target = { alienPositions[alien].x + alienHalfWidth, alienPositions[alien].y + alienHalfHeight };
+        const float speed = Vector2Length(playerBulletVelocities[i]);
+        const Vector2 desired = Vector2Scale(Vector2Normalize(Vector2Subtract(target, playerBulletPositions[i])), speed);
+        playerBulletVelocities[i] = Vector2Scale(Vector2Normalize(Vector2Lerp(playerBulletVelocities[i], desired, playerBulletHomingRates[i])), speed);
+    }
+    for (int i = 0; i < alienBulletExtent; ++i)
+    {
+        if (!alienBulletAlive[i] || alienBulletHomingRates[i] == 0 || alienBulletPositions[i].y > playerCenter.y)
+            continue;
+        const float speed = Vector2Length(alienBulletVelocities[i]);
+        const Vector2 desired = Vector2Scale(Vector2Normalize(Vector2Subtract(playerCenter, alienBulletPositions[i])), speed);
+        alienBulletVelocities[i] = Vector2Scale(Vector2Normalize(Vector2Lerp(alienBulletVelocities[i], desired, alienBulletHomingRates[i])), speed);
+        alienBulletDrifts[i] = alienBulletVelocities[i];
+    }
+}
+
+void BuildHomingGrid()
+{
+    static short cellEnds[HOMING_GRID_CELL_COUNT];
+    memset(homingGridStarts, 0, sizeof(homingGridStarts));
+    for (int i = 0; i < alienExtent; ++i)
+    {
+        if (alienAlive[i])
+            ++homingGridStarts[GetHomingCell(alienPositions[i]) + 1];
+    }
+    for (int cell = 0; cell < HOMING_GRID_CELL_COUNT; ++cell)
+    {
+        homingGridStarts[cell + 1] += homingGridStarts[cell];
+        cellEnds[cell] = homingGridStarts[cell];
+    }
+    for (int i = 0; i < alienExtent; ++i)
+    {
+        if (alienAlive[i])
+            homingGridAliens[cellEnds[GetHomingCell(alienPositions[i])]++] = i;
+    }
+}
+
+int GetHomingCell(Vector2 point)
+{
+    const int column = Clamp((point.x + alienHalfWidth - cameraBounds.x) / homingCellSize, 0, HOMING_GRID_COLUMNS - 1);
+    const int row = Clamp((point.y + alienHalfHeight - cameraBounds.y) / homingCellSize, 0, HOMING_GRID_ROWS - 1);
+    return row * HOMING_GRID_COLUMNS + column;
+}
+
+int FindNearestAlien(Vector2 point)
+{
+    const Vector2 corner = { point.x - alienHalfWidth, point.y - alienHalfHeight };
+    const int cell = GetHomingCell(corner);
+    const int column = cell % HOMING_GRID_COLUMNS;
+    const int row = cell / HOMING_GRID_COLUMNS;
+    int nearest = -1;
+    float nearestDistance = 0;
+    for (int ring = 0; ring < HOMING_GRID_COLUMNS; ++ring)
+    {
+        if (nearest >= 0 && ring > 0 && (ring - 1) * homingCellSize * (ring - 1) * homingCellSize > nearestDistance)
+            break;
+        for (int y = row - ring; y <= row + ring; ++y)
+        {
+            if (y < 0 || y >= HOMING_GRID_ROWS)
+                continue;
+            const int step = y == row - ring || y == row + ring ? 1 : ring * 2;
+            for (int x = column - ring; x <= column + ring; x += step)
+            {
+                if (x < 0 || x >= HOMING_GRID_COLUMNS)
+                    continue;
+                const int searchCell = y * HOMING_GRID_COLUMNS + x;
+                for (int k = homingGridStarts[searchCell]; k < homingGridStarts[searchCell + 1]; ++k)
+                {
+                    const int alien = homingGridAliens[k];
+                    const float distance = Vector2DistanceSqr(corner, alienPositions[alien]);
+                    if (nearest < 0 || distance < nearestDistance)
+                    {
+                        nearest = alien;
+                        nearestDistance = distance;
+                    }
+                }
+            }
+        }
+    }
+    return nearest;
+}
+
+void IntegrateSystem(ArchetypeId archetype)
+{
+    const Archetype *type = &archetypes[archetype];
+    if ((type->components & (positionComponent | velocityComponent)) != (positionComponent | velocityComponent))
+        return;
+    float *restrict positions = (float *)type->positions;
+    const float *restrict velocities = (const float *)type->velocities;
+    const int count = *type->extent * 2;
+    int i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(positions + i, _mm_add_ps(_mm_loadu_ps(positions + i), _mm_loadu_ps(velocities + i)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        positions[i] += velocities[i];
+    }
+}
+
+bool UpdateCollisionSystem()
+{
+    const Vector2 playerCenter = { playerPositions[0].x + playerHalfWidth, playerPositions[0].y + playerHalfHeight };
+    for (int i = 0; i < dropExtent; ++i)
+    {
+        if (dropAlive[i] && CheckCollisionCircles(dropPositions[i], dropRadii[i], playerCenter, playerHalfWidth))
+        {
+            ActivatePowerUp(dropKinds[i]);
+            DespawnEntity(dropArchetype, i);
+        }
+    }
+    for (int i = 0; i < playerBulletExtent; ++i)
+    {
+        if (!playerBulletAlive[i])
+            continue;
+        for (int j = 0; j < alienExtent; ++j)
+        {
+            if (alienAlive[j] && CheckCollisionCircles(playerBulletPositions[i], playerBulletRadii[i], (Vector2) { alienPositions[j].x + alienHalfWidth, alienPositions[j].y + alienHalfHeight }, alienHalfWidth))
+            {
+                DespawnEntity(playerBulletArchetype, i);
+                if (--alienHitPoints[j] > 0)
+                {
+                    alienHitFlashes[j] = true;
+                    ScheduleTimer(flashTimerEvent, SecondsToTicks(hitFlashDuration), GetEntityHandle(alienArchetype, j), 0);
+                    PlaySoundEffect(alienHitSoundEffect, alienPositions[j].x + alienHalfWidth);
+                    break;
+                }
+                DespawnEntity(alienArchetype, j);
+                --alienCount;
+                score += alienTypes[alienTypeIds[j]].score;
+                PlaySoundEffect(alienDeathSoundEffect, alienPositions[j].x + alienHalfWidth);
+                if (alienCount == 0)
+                {
+                    ChangeGameState(winState);
+                    return true;
+                }
+                if (RandomValue(1, dropOdds) == 1)
+                    SpawnDrop((Vector2) { alienPositions[j].x + alienHalfWidth, alienPositions[j].y + alienHalfHeight });
+                UpdateFormationExtents();
+                break;
+            }
+        }
+        for (int j = 0; j < ufoExtent && playerBulletAlive[i]; ++j)
+        {
+            if (ufoAlive[j] && CheckCollisionCircleRec(playerBulletPositions[i], playerBulletRadii[i], (Rectangle) { ufoPositions[j].x, ufoPositions[j].y, ufoWidth, ufoHeight }))
+            {
+                DespawnEntity(playerBulletArchetype, i);
+                DespawnEntity(ufoArchetype, j);
+                score += ufoScores[RandomValue(0, 3)];
+                homingMissilesRemaining += ufoMissileReward;
+                PlaySoundEffect(alienDeathSoundEffect, ufoPositions[j].x + ufoWidth * 0.5f);
+            }
+        }
+    }
+    for (int i = 0; i < alienBulletExtent; ++i)
+    {
+        if (!alienBulletAlive[i] || !CheckCollisionCircles(alienBulletPositions[i], alienBulletRadii[i], playerCenter, playerHalfWidth))
+            continue;
+        if (powerUpActive[shieldPowerUp])
+        {
+            DespawnEntity(alienBulletArchetype, i);
+            continue;
+        }
+        playerKiller = IsEntityHandleValid(alienArchetype, alienBulletOwners[i]) ? alienBulletOwners[i] : nullHandle;
+        PlaySoundEffect(playerDeathSoundEffect, playerCenter.x);
+        ChangeGameState(loseState);
+        return true;
+    }
+    return false;
+}
+
+void CullSystem()
+{
+    for (int a = 0; a < ARCHETYPE_COUNT; ++a)
+    {
+        const Archetype *type = &archetypes[a];
+        if (!(type->components & boundedComponent))
+            continue;
+        for (int i = 0; i < *type->extent; ++i)
+        {
+            if (type->alive[i] && (type->positions[i].y < cameraBounds.y || type->positions[i].y > cameraBounds.y + cameraBounds.height || type->positions[i].x < cameraBounds.x || type->positions[i].x > cameraBounds.x + cameraBounds.width))
+            {
+                DespawnEntity(a, i);
+            }
+        }
+    }
+}
+
+void DrawSpriteSystem()
+{
+    for (int a = 0; a < ARCHETYPE_COUNT; ++a)
+    {
+        const Archetype *type = &archetypes[a];
+        if (!(type->components & spriteComponent))
+            continue;
+        const int frameWidth = type->texture->width / type->frameCount;
+        const int frameHeight = type->texture->height / type->typeCount;
+        const float animationTime = GetAnimationTime();
+        const bool shaded = type->phases != NULL && BeginAnimationShader(type, animationTime);
+        for (int t = 0; t < type->typeCount; ++t)
+        {
+            Rectangle source = { 0, t * frameHeight, frameWidth, frameHeight };
+            for (int i = 0; i < *type->extent; ++i)
+            {
+                if (!type->alive[i] || (type->types != NULL && type->types[i] != t))
+                    continue;
+                if (shaded)
+                {
+                    DrawTextureRec(*type->texture, source, type->positions[i], (Color) { 255, 255, 255, type->phases[i] });
+                }
+                else
+                {
+                    source.x = type->phases != NULL ? GetAnimationFrame(animationTime, type->phases[i], type->frameCount) * frameWidth : 0;
+                    DrawTextureRec(*type->texture, source, type->positions[i], WHITE);
+                }
+            }
+        }
+        if (shaded)
+            EndShaderMode();
+    }
+}
+
+float GetAnimationTime()
+{
+    return timerTick * tickTime / animationThreshold;
+}
+
+int GetAnimationFrame(float animationTime, unsigned char phase, int frameCount)
+{
+    return (int)floorf(animationTime + phase / 255.0f * frameCount) % frameCount;
+}
+
+bool BeginAnimationShader(const Archetype *type, float animationTime)
+{
+    if (alienShader.id == 0 || alienShader.id == rlGetShaderIdDefault())
+        return false;
+    const float frameWidth = 1.0f / type->frameCount;
+    const float frameCount = type->frameCount;
+    SetShaderValue(alienShader, alienShaderTimeLocation, &animationTime, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(alienShader, alienShaderFrameWidthLocation, &frameWidth, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(alienShader, alienShaderFrameCountLocation, &frameCount, SHADER_UNIFORM_FLOAT);
+    BeginShaderMode(alienShader);
+    return true;
+}
+
+void DrawCircleSystem()
+{
+    for (int a = 0; a < ARCHETYPE_COUNT; ++a)
+    {
+        const Archetype *type = &archetypes[a];
+        if (!(type->components & circleComponent))
+            continue;
+        for (int i = 0; i < *type->extent; ++i)
+        {
+            if (type->alive[i])
+            {
+                DrawCircleV(type->positions[i], type->radii[i], type->colors[i]);
+            }
+        }
+    }
+}
+
+EntityHandle MakeHandle(int index, unsigned short generation)
+{
+    return ((EntityHandle)generation << HANDLE_INDEX_BITS) | (EntityHandle)index;
+}
+
+int GetHandleIndex(EntityHandle handle)
+{
+    return handle & HANDLE_INDEX_MASK;
+}
+
+unsigned short GetHandleGeneration(EntityHandle handle)
+{
+    return handle >> HANDLE_INDEX_BITS;
+}
+
+unsigned short NextGeneration(unsigned short generation)
+{
+    return generation == 0xFFFF ? 1 : generation + 1;
+}
+
+EntityHandle GetEntityHandle(ArchetypeId archetype, int index)
+{
+    const Archetype *type = &archetypes[archetype];
+    return type->alive[index] ? MakeHandle(index, type->generations[index]) : nullHandle;
+}
+
+bool IsEntityHandleValid(ArchetypeId archetype, EntityHandle handle)
+{
+    const Archetype *type = &archetypes[archetype];
+    const int index = GetHandleIndex(handle);
+    return handle != nullHandle && index < type->capacity && type->alive[index] && type->generations[index] == GetHandleGeneration(handle);
+}
+
+float *RenderSoundEffect(SoundEffect effect, int *frameCount)
+{
+    const int attackFrames = effect.attack * soundEffectStepTime * soundEffectSampleRate;
+    const int sustainFrames = effect.sustain * soundEffectStepTime * soundEffectSampleRate;
+    const int decayFrames = effect.decay * soundEffectStepTime * soundEffectSampleRate;
+    *frameCount = attackFrames + sustainFrames + decayFrames;
+    float *samples = RL_MALLOC(*frameCount * sizeof(float));
+    const float sweep = logf((float)effect.endFrequency / effect.startFrequency) / (*frameCount > 1 ? *frameCount - 1 : 1);
+    const float duty = effect.dutyCycle / 256.0f;
+    unsigned int noiseState = 0x2545F491u;
+    float noise = 0;
+    float phase = 0;
+    for (int i = 0; i < *frameCount; ++i)
+    {
+        float envelope = 1;
+        if (i < attackFrames)
+            envelope = (float)i / attackFrames;
+        else if (i >= attackFrames + sustainFrames)
+            envelope = 1 - (float)(i - attackFrames - sustainFrames) / decayFrames;
+        phase += effect.startFrequency * expf(sweep * i) / soundEffectSampleRate;
+        if (phase >= 1)
+        {
+            phase -= (int)phase;
+            noiseState ^= noiseState << 13;
+            noiseState ^= noiseState >> 17;
+            noiseState ^= noiseState << 5;
+            noise = (noiseState & 0xFFFF) / 32768.0f - 1;
+        }
+        float sample = noise;
+        if (effect.shape == squareShape)
+            sample = phase < duty ? 1 : -1;
+        else if (effect.shape == sawtoothShape)
+            sample = phase * 2 - 1;
+        samples[i] = sample * envelope * effect.volume / 256.0f;
+    }
+    return samples;
+}
+
+void PlaySoundEffect(SoundEffectId effect, float x)
+{
+    if (!mixerReady || attractDemo != NULL)
+        return;
+    const unsigned int tail = atomic_load_explicit(&voiceQueueTail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&voiceQueueHead, memory_order_acquire) >= VOICE_QUEUE_SIZE)
+        return;
+    const float angle = Clamp((x - cameraBounds.x) / cameraBounds.width, 0, 1) * PI * 0.5f;
+    voiceQueue[tail % VOICE_QUEUE_SIZE] = (VoiceCommand) { effect, cosf(angle), sinf(angle) };
+    atomic_store_explicit(&voiceQueueTail, tail + 1, memory_order_release);
+}
+
+void MixSoundEffects(void *bufferData, unsigned int frames)
+{
+    const double start = GetTimestamp();
+    float *output = bufferData;
+    memset(output, 0, frames * 2 * sizeof(float));
+    const unsigned int tail = atomic_load_explicit(&voiceQueueTail, memory_order_acquire);
+    for (unsigned int head = atomic_load_explicit(&voiceQueueHead, memory_order_relaxed); head != tail; ++head)
+    {
+        const VoiceCommand command = voiceQueue[head % VOICE_QUEUE_SIZE];
+        int slot = 0;
+        for (int i = 0; i < MAX_VOICE_COUNT; ++i)
+        {
+            if (voices[i].samples == NULL)
+            {
+                slot = i;
+                break;
+            }
+            if (voices[i].frameCount - voices[i].position < voices[slot].frameCount - voices[slot].position)
+                slot = i;
+        }
+        voices[slot] = (Voice) { soundEffectSamples[command.effect], soundEffectFrameCounts[command.effect], 0, command.leftGain, command.rightGain };
+    }
+    atomic_store_explicit(&voiceQueueHead, tail, memory_order_release);
+    for (int i = 0; i < MAX_VOICE_COUNT; ++i)
+    {
+        if (voices[i].samples != NULL)
+        {
+            const int count = voices[i].frameCount - voices[i].position < (int)frames ? voices[i].frameCount - voices[i].position : (int)frames;
+            MixVoice(output, voices[i].samples + voices[i].position, count, voices[i].leftGain, voices[i].rightGain);
+            voices[i].position += count;
+            if (voices[i].position >= voices[i].frameCount)
+                voices[i].samples = NULL;
+        }
+    }
+    unsigned int i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+    const __m128 low = _mm_set1_ps(-1);
+    const __m128 high = _mm_set1_ps(1);
+    for (; i + 4 <= frames * 2; i += 4)
+    {
+        _mm_storeu_ps(output + i, _mm_max_ps(low, _mm_min_ps(high, _mm_loadu_ps(output + i))));
+    }
+#endif
+    for (; i < frames * 2; ++i)
+    {
+        output[i] = Clamp(output[i], -1, 1);
+    }
+    const unsigned int elapsed = (GetTimestamp() - start) * 1e9;
+    atomic_store_explicit(&mixerLastNanoseconds, elapsed, memory_order_relaxed);
+    if (elapsed > atomic_load_explicit(&mixerMaxNanoseconds, memory_order_relaxed))
+        atomic_store_explicit(&mixerMaxNanoseconds, elapsed, memory_order_relaxed);
+    atomic_fetch_add_explicit(&mixerTotalNanoseconds, elapsed, memory_order_relaxed);
+    atomic_fetch_add_explicit(&mixerCallbackCount, 1, memory_order_relaxed);
+}
+
+void MixVoice(float *output, const float *samples, int frameCount, float leftGain, float rightGain)
+{
+    int i = 0;
+#if defined(__SSE__) || defined(_M_X64)
+    const __m128 gains = _mm_setr_ps(leftGain, rightGain, leftGain, rightGain);
+    for (; i + 4 <= frameCount; i += 4)
+    {
+        const __m128 mono = _mm_loadu_ps(samples + i);
+        float *frame = output + i * 2;
+        _mm_storeu_ps(frame, _mm_add_ps(_mm_loadu_ps(frame), _mm_mul_ps(_mm_unpacklo_ps(mono, mono), gains)));
+        _mm_storeu_ps(frame + 4, _mm_add_ps(_mm_loadu_ps(frame + 4), _mm_mul_ps(_mm_unpackhi_ps(mono, mono), gains)));
+    }
+#endif
+    for (; i < frameCount; ++i)
+    {
+        output[i * 2] += samples[i] * leftGain;
+        output[i * 2 + 1] += samples[i] * rightGain;
+    }
+}
+
+void PrintMixerReport()
+{
+    const unsigned int callbacks = atomic_load(&mixerCallbackCount);
+    const unsigned long long total = atomic_load(&mixerTotalNanoseconds);
+    printf("mixer: %u callbacks, last %.2fus, mean %.2fus, max %.2fus (%d frame buffers at %d Hz)\n", callbacks, atomic_load(&mixerLastNanoseconds) / 1000.0, callbacks > 0 ? total / 1000.0 / callbacks : 0, atomic_load(&mixerMaxNanoseconds) / 1000.0, mixerBufferFrames, soundEffectSampleRate);
+}
+
+bool BeginReplayRecording(const char *path)
+{
+    replayRecordFile = fopen(path, "wb");
+    if (replayRecordFile == NULL)
+        return false;
+    replayRecordHeader = (ReplayHeader) { replayMagic, replayVersion, 0, 0, 0, 0, 0, GetGameStateSize() };
+    fwrite(&replayRecordHeader, sizeof(replayRecordHeader), 1, replayRecordFile);
+    replayKeyframeBuffer = RL_MALLOC(GetGameStateSize());
+    replayRecordBlock.firstTick = 0;
+    replayRecordRunCount = 0;
+    WriteReplayKeyframe();
+    return true;
+}
+
+void RecordReplayTick(unsigned int keys)
+{
+    if (replayRecordFile == NULL)
+        return;
+    const unsigned int tick = replayRecordHeader.tickCount;
+    if (tick > 0 && tick % replayKeyframeTicks == 0)
+        WriteReplayKeyframe();
+    unsigned short *run = replayRecordRunCount > 0 ? &replayRecordBlock.runs[replayRecordRunCount - 1] : NULL;
+    if (run != NULL && (unsigned int)(*run >> REPLAY_RUN_LENGTH_BITS) == keys && (*run & replayMaxRunLength) < replayMaxRunLength)
+    {
+        ++*run;
+    }
+    else
+    {
+        if (replayRecordRunCount == REPLAY_BLOCK_RUN_COUNT)
+            FlushReplayBlock();
+        replayRecordBlock.runs[replayRecordRunCount++] = (keys << REPLAY_RUN_LENGTH_BITS) | 1;
+    }
+    ++replayRecordHeader.tickCount;
+}
+
+void FlushReplayBlock()
+{
+    for (int i = replayRecordRunCount; i < REPLAY_BLOCK_RUN_COUNT; ++i)
+    {
+        replayRecordBlock.runs[i] = 0;
+    }
+    const ReplayIndexEntry entry = { replayRecordBlock.firstTick, (unsigned int)ftell(replayRecordFile), sizeof(ReplayBlock) };
+    fwrite(&replayRecordBlock, sizeof(replayRecordBlock), 1, replayRecordFile);
+    AppendReplayIndexEntry(&replayBlockEntries, &replayBlockCapacity, replayRecordHeader.blockCount++, entry);
+    replayRecordBlock.firstTick = replayRecordHeader.tickCount;
+    replayRecordRunCount = 0;
+}
+
+void WriteReplayKeyframe()
+{
+    static const unsigned char padding[4];
+    const int size = SaveGameState(replayKeyframeBuffer);
+    const ReplayIndexEntry entry = { replayRecordHeader.tickCount, (unsigned int)ftell(replayRecordFile), size };
+    fwrite(replayKeyframeBuffer, size, 1, replayRecordFile);
+    fwrite(padding, (4 - size % 4) % 4, 1, replayRecordFile);
+    AppendReplayIndexEntry(&replayKeyframeEntries, &replayKeyframeCapacity, replayRecordHeader.keyframeCount++, entry);
+}
+
+void AppendReplayIndexEntry(ReplayIndexEntry **entries, int *capacity, unsigned int count, ReplayIndexEntry entry)
+{
+    if ((int)count == *capacity)
+    {
+        *capacity = *capacity > 0 ? *capacity * 2 : 64;
+        *entries = RL_REALLOC(*entries, *capacity * sizeof(ReplayIndexEntry));
+    }
+    (*entries)[count] = entry;
+}
+
+void EndReplayRecording()
+{
+    if (replayRecordFile == NULL)
+        return;
+    if (replayRecordRunCount > 0)
+        FlushReplayBlock();
+    replayRecordHeader.blockIndexOffset = ftell(replayRecordFile);
+    fwrite(replayBlockEntries, sizeof(ReplayIndexEntry), replayRecordHeader.blockCount, replayRecordFile);
+    replayRecordHeader.keyframeIndexOffset = ftell(replayRecordFile);
+    fwrite(replayKeyframeEntries, sizeof(ReplayIndexEntry), replayRecordHeader.keyframeCount, replayRecordFile);
+    fseek(replayRecordFile, 0, SEEK_SET);
+    fwrite(&replayRecordHeader, sizeof(replayRecordHeader), 1, replayRecordFile);
+    fclose(replayRecordFile);
+    replayRecordFile = NULL;
+    RL_FREE(replayBlockEntries);
+    replayBlockEntries = NULL;
+    replayBlockCapacity = 0;
+    RL_FREE(replayKeyframeEntries);
+    replayKeyframeEntries = NULL;
+    replayKeyframeCapacity = 0;
+    RL_FREE(replayKeyframeBuffer);
+    replayKeyframeBuffer = NULL;
+}
+
+bool OpenReplay(const char *path)
+{
+    CloseReplay();
+#if defined(_WIN32)
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return false;
+    fseek(file, 0, SEEK_END);
+    replayDataSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *data = RL_MALLOC(replayDataSize);
+    const bool loaded = fread(data, 1, replayDataSize, file) == (size_t)replayDataSize;
+    fclose(file);
+    replayData = data;
+    if (!loaded)
+    {
+        CloseReplay();
+        return false;
+    }
+#else
+    const int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size < (off_t)sizeof(ReplayHeader))
+    {
+        close(file);
+        return false;
+    }
+    void *mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED)
+        return false;
+    replayData = mapping;
+    replayDataSize = status.st_size;
+#endif
+    replayHeader = (const ReplayHeader *)replayData;
+    if (!IsReplayValid())
+    {
+        CloseReplay();
+        return false;
+    }
+    replayBlockIndex = (const ReplayIndexEntry *)(replayData + replayHeader->blockIndexOffset);
+    replayKeyframeIndex = (const ReplayIndexEntry *)(replayData + replayHeader->keyframeIndexOffset);
+    replayPlaying = true;
+    return SeekReplay(0);
+}
+
+bool IsReplayValid()
+{
+    const unsigned long size = replayDataSize;
+    if (size < sizeof(ReplayHeader) || replayHeader->magic != replayMagic || replayHeader->version != replayVersion || replayHeader->stateSize != (unsigned int)GetGameStateSize() || replayHeader->keyframeCount == 0)
+        return false;
+    if (replayHeader->blockIndexOffset > size || replayHeader->blockCount > (size - replayHeader->blockIndexOffset) / sizeof(ReplayIndexEntry))
+        return false;
+    if (replayHeader->keyframeIndexOffset > size || replayHeader->keyframeCount > (size - replayHeader->keyframeIndexOffset) / sizeof(ReplayIndexEntry))
+        return false;
+    const ReplayIndexEntry *blocks = (const ReplayIndexEntry *)(replayData + replayHeader->blockIndexOffset);
+    for (unsigned int i = 0; i < replayHeader->blockCount; ++i)
+    {
+        if (blocks[i].offset > size || blocks[i].size != sizeof(ReplayBlock) || blocks[i].size > size - blocks[i].offset)
+            return false;
+    }
+    const ReplayIndexEntry *keyframes = (const ReplayIndexEntry *)(replayData + replayHeader->keyframeIndexOffset);
+    for (unsigned int i = 0; i < replayHeader->keyframeCount; ++i)
+    {
+        if (keyframes[i].tick > replayHeader->tickCount || keyframes[i].offset > size || keyframes[i].size > replayHeader->stateSize || keyframes[i].size > size - keyframes[i].offset)
+            return false;
+    }
+    return true;
+}
+
+bool SeekReplay(unsigned int tick)
+{
+    if (!replayPlaying)
+        return false;
+    if (tick > replayHeader->tickCount)
+        tick = replayHeader->tickCount;
+    int low = 0;
+    int high = replayHeader->keyframeCount - 1;
+    while (low < high)
+    {
+        const int middle = (low + high + 1) / 2;
+        if (replayKeyframeIndex[middle].tick <= tick)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    const ReplayIndexEntry keyframe = replayKeyframeIndex[low];
+    if (!LoadGameState(replayData + keyframe.offset, keyframe.size))
+    {
+        CloseReplay();
+        return false;
+    }
+    low = 0;
+    high = replayHeader->blockCount > 0 ? replayHeader->blockCount - 1 : 0;
+    while (low < high)
+    {
+        const int middle = (low + high + 1) / 2;
+        if (replayBlockIndex[middle].tick <= keyframe.tick)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    replayBlock = low;
+    replayRun = 0;
+    replayRunTick = 0;
+    replayTick = replayHeader->blockCount > 0 ? replayBlockIndex[low].tick : 0;
+    unsigned int keys;
+    while (replayTick < keyframe.tick)
+    {
+        if (!NextReplayInput(&keys))
+            break;
+    }
+    while (replayTick < tick)
+    {
+        if (!NextReplayInput(&input))
+            break;
+        frameTime = tickTime;
+        UpdateSimulation();
+    }
+    return true;
+}
+
+bool NextReplayInput(unsigned int *keys)
+{
+    if (!replayPlaying || replayTick >= replayHeader->tickCount || (unsigned int)replayBlock >= replayHeader->blockCount)
+        return false;
+    const ReplayBlock *block = (const ReplayBlock *)(replayData + replayBlockIndex[replayBlock].offset);
+    const unsigned short run = block->runs[replayRun];
+    *keys = run >> REPLAY_RUN_LENGTH_BITS;
+    ++replayTick;
+    if (++replayRunTick == (run & replayMaxRunLength))
+    {
+        replayRunTick = 0;
+        if (++replayRun == REPLAY_BLOCK_RUN_COUNT || block->runs[replayRun] == 0)
+        {
+            replayRun = 0;
+            ++replayBlock;
+        }
+    }
+    return true;
+}
+
+void CloseReplay()
+{
+    if (replayData == NULL)
+        return;
+#if defined(_WIN32)
+    RL_FREE((void *)replayData);
+#else
+    munmap((void *)replayData, replayDataSize);
+#endif
+    replayData = NULL;
+    replayDataSize = 0;
+    replayPlaying = false;
+}
+
+void UpdateAttractMode()
+{
+    if (attractDemo != NULL)
+    {
+        if (gameState == startState)
+            StopAttractDemo();
+        return;
+    }
+    if (gameState != startState || input != 0 || instanceCount > 1 || replayPlaying || replayRecordFile != NULL || botUpdate != NULL)
+    {
+        attractIdleTicks = 0;
+        return;
+    }
+    if (++attractIdleTicks >= SecondsToTicks(attractDelay))
+        StartAttractDemo();
+}
+
+void StartAttractDemo()
+{
+    attractDemo = &attractDemos[attractDemoIndex];
+    attractDemoIndex = (attractDemoIndex + 1) % ATTRACT_DEMO_COUNT;
+    attractRun = 0;
+    attractRunTick = 0;
+    attractIdleTicks = 0;
+    ResetGame();
+    SeedRandom(attractDemo->seed);
+    wave = attractDemo->startWave;
+    ChangeGameState(readyState);
+    SetTargetFPS(attractFPS);
+}
+
+bool NextAttractInput(unsigned int *keys)
+{
+    if (attractRun >= attractDemo->runCount)
+        return false;
+    const unsigned short run = attractDemo->runs[attractRun];
+    *keys = run >> REPLAY_RUN_LENGTH_BITS;
+    if (++attractRunTick == (run & replayMaxRunLength))
+    {
+        attractRunTick = 0;
+        ++attractRun;
+    }
+    return true;
+}
+
+void StopAttractDemo()
+{
+    attractDemo = NULL;
+    attractIdleTicks = 0;
+    ResetGame();
+    SeedRandom((unsigned int)time(NULL));
+    SetTargetFPS(targetFPS);
+}
+
+void DrawAttractOverlay()
+{
+    const int attractHalfWidth = MeasureText("DEMO - Press SHOOT To Play!", textSize) * 0.5;
+    DrawText("DEMO - Press SHOOT To Play!", screenHalfWidth - attractHalfWidth, 80, textSize, GRAY);
+}
+
+bool LoadHighScores()
+{
+    highScoreCount = 0;
+    snprintf(highScoreLogPath, sizeof(highScoreLogPath), "%s%s", GetApplicationDirectory(), highScoreLogName);
+    snprintf(highScoreCompactPath, sizeof(highScoreCompactPath), "%s%s", GetApplicationDirectory(), highScoreCompactName);
+#if defined(_WIN32)
+    FILE *file = fopen(highScoreLogPath, "rb");
+    if (file != NULL)
+    {
+        HighScoreRecord record;
+        while (fread(&record, sizeof(record), 1, file) == 1)
+        {
+            if (record.magic == highScoreMagic && record.checksum == GetHighScoreChecksum(&record))
+                InsertHighScore(highScores, &highScoreCount, record);
+        }
+        fclose(file);
+    }
+#else
+    highScoreLog = open(highScoreLogPath, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (highScoreLog < 0)
+        return false;
+    struct stat status;
+    if (fstat(highScoreLog, &status) != 0)
+    {
+        close(highScoreLog);
+        highScoreLog = -1;
+        return false;
+    }
+    const long recordCount = status.st_size / sizeof(HighScoreRecord);
+    if (status.st_size % sizeof(HighScoreRecord) != 0 && ftruncate(highScoreLog, recordCount * sizeof(HighScoreRecord)) != 0)
+    {
+        close(highScoreLog);
+        highScoreLog = -1;
+        return false;
+    }
+    if (recordCount > 0)
+    {
+        const HighScoreRecord *records = mmap(NULL, recordCount * sizeof(HighScoreRecord), PROT_READ, MAP_PRIVATE, highScoreLog, 0);
+        if (records != MAP_FAILED)
+        {
+            for (long i = 0; i < recordCount; ++i)
+            {
+                if (records[i].magic == highScoreMagic && records[i].checksum == GetHighScoreChecksum(&records[i]))
+                    InsertHighScore(highScores, &highScoreCount, records[i]);
+            }
+            munmap((void *)records, recordCount * sizeof(HighScoreRecord));
+        }
+    }
+    memcpy(loggedHighScores, highScores, sizeof(highScores));
+    loggedHighScoreCount = highScoreCount;
+    highScoreLogRecords = recordCount;
+    highScoreStopping = false;
+    droppedHighScoreCount = 0;
+    if (pthread_create(&highScoreThread, NULL, RunHighScoreWriter, NULL) != 0)
+    {
+        close(highScoreLog);
+        highScoreLog = -1;
+        return false;
+    }
+#endif
+    highScoreReady = true;
+    return true;
+}
+
+void SubmitHighScore(int finalScore, int finalWave)
+{
+    if (!highScoreReady || finalScore <= 0)
+        return;
+    HighScoreRecord record = { highScoreMagic, finalScore, finalWave, (unsigned int)time(NULL), 0 };
+    record.checksum = GetHighScoreChecksum(&record);
+    if (!InsertHighScore(highScores, &highScoreCount, record))
+        return;
+#if defined(_WIN32)
+    FILE *file = fopen(highScoreLogPath, "ab");
+    if (file != NULL)
+    {
+        if (fwrite(&record, sizeof(record), 1, file) == 1 && fflush(file) == 0)
+            _commit(_fileno(file));
+        fclose(file);
+    }
+#else
+    pthread_mutex_lock(&highScoreMutex);
+    if (highScoreQueueHead - highScoreQueueTail == HIGH_SCORE_QUEUE_SIZE)
+    {
+        ++droppedHighScoreCount;
+    }
+    else
+    {
+        highScoreQueue[highScoreQueueHead % HIGH_SCORE_QUEUE_SIZE] = record;
+        ++highScoreQueueHead;
+        pthread_cond_broadcast(&highScoreCondition);
+    }
+    pthread_mutex_unlock(&highScoreMutex);
+#endif
+}
+
+void StopHighScoreWriter()
+{
+    if (!highScoreReady)
+        return;
+    highScoreReady = false;
+#if !defined(_WIN32)
+    pthread_mutex_lock(&highScoreMutex);
+    highScoreStopping = true;
+    pthread_cond_broadcast(&highScoreCondition);
+    pthread_mutex_unlock(&highScoreMutex);
+    pthread_join(highScoreThread, NULL);
+    close(highScoreLog);
+    highScoreLog = -1;
+    if (droppedHighScoreCount > 0)
+        fprintf(stderr, "%s: %d high scores dropped because the writer queue was full\n", highScoreLogPath, droppedHighScoreCount);
+#endif
+}
+
+bool InsertHighScore(HighScoreRecord *table, int *count, HighScoreRecord record)
+{
+    if (*count == HIGH_SCORE_COUNT && record.score <= table[HIGH_SCORE_COUNT - 1].score)
+        return false;
+    int i = *count < HIGH_SCORE_COUNT ? (*count)++ : HIGH_SCORE_COUNT - 1;
+    while (i > 0 && table[i - 1].score < record.score)
+    {
+        table[i] = table[i - 1];
+        --i;
+    }
+    table[i] = record;
+    return true;
+}
+
+unsigned int GetHighScoreChecksum(const HighScoreRecord *record)
+{
+    return HashSeed(HashSeed(record->magic, record->score, record->wave), record->timestamp, highScoreChecksumSalt);
+}
+
+#if !defined(_WIN32)
+void *RunHighScoreWriter(void *argument)
+{
+    (void)argument;
+    pthread_mutex_lock(&highScoreMutex);
+    while (!highScoreStopping || highScoreQueueTail != highScoreQueueHead)
+    {
+        if (highScoreQueueTail == highScoreQueueHead)
+        {
+            pthread_cond_wait(&highScoreCondition, &highScoreMutex);
+            continue;
+        }
+        const HighScoreRecord record = highScoreQueue[highScoreQueueTail % HIGH_SCORE_QUEUE_SIZE];
+        ++highScoreQueueTail;
+        pthread_mutex_unlock(&highScoreMutex);
+        AppendHighScoreRecord(record);
+        pthread_mutex_lock(&highScoreMutex);
+    }
+    pthread_mutex_unlock(&highScoreMutex);
+    return NULL;
+}
+
+void AppendHighScoreRecord(HighScoreRecord record)
+{
+    if (write(highScoreLog, &record, sizeof(record)) != sizeof(record))
+    {
+        if (ftruncate(highScoreLog, highScoreLogRecords * sizeof(HighScoreRecord)) != 0)
+            perror(highScoreLogPath);
+        return;
+    }
+    fsync(highScoreLog);
+    ++highScoreLogRecords;
+    InsertHighScore(loggedHighScores, &loggedHighScoreCount, record);
+    if (highScoreLogRecords >= highScoreCompactThreshold)
+        CompactHighScoreLog();
+}
+
+void CompactHighScoreLog()
+{
+    const int compacted = open(highScoreCompactPath, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (compacted < 0)
+        return;
+    const ssize_t bytes = loggedHighScoreCount * sizeof(HighScoreRecord);
+    if (write(compacted, loggedHighScores, bytes) != bytes || fsync(compacted) != 0 || rename(highScoreCompactPath, highScoreLogPath) != 0)
+    {
+        close(compacted);
+        unlink(highScoreCompactPath);
+        return;
+    }
+    const int directory = open(GetApplicationDirectory(), O_RDONLY);
+    if (directory >= 0)
+    {
+        fsync(directory);
+        close(directory);
+    }
+    close(highScoreLog);
+    highScoreLog = compacted;
+    highScoreLogRecords = loggedHighScoreCount;
+}
+#endif
+
+bool OpenAutomation(const char *path)
+{
+#if defined(_WIN32)
+    fprintf(stderr, "automation requires Unix domain sockets\n");
+    return false;
+#else
+    struct sockaddr_un address = { 0 };
+    if (strlen(path) >= sizeof(address.sun_path))
+        return false;
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    automationListener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (automationListener < 0)
+        return false;
+    unlink(path);
+    if (bind(automationListener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(automationListener, automationBacklog) != 0 || fcntl(automationListener, F_SETFL, O_NONBLOCK) != 0)
+    {
+        close(automationListener);
+        automationListener = -1;
+        return false;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    automationPath = path;
+    return true;
+#endif
+}
+
+void ServiceAutomation()
+{
+#if !defined(_WIN32)
+    if (automationListener < 0)
+        return;
+    if (automationStepTicks > 0)
+    {
+        const unsigned int ticks = automationStepTicks < automationStepTicksPerFrame ? automationStepTicks : automationStepTicksPerFrame;
+        for (unsigned int i = 0; i < ticks; ++i)
+        {
+            UpdateTick();
+        }
+        SelectInstance(0);
+        automationStepTicks -= ticks;
+        if (automationStepTicks > 0)
+            return;
+        if (automationClient >= 0 && send(automationClient, &automationStepReply, sizeof(automationStepReply), 0) != (ssize_t)sizeof(automationStepReply))
+        {
+            close(automationClient);
+            automationClient = -1;
+        }
+    }
+    if (automationClient < 0)
+    {
+        automationClient = accept(automationListener, NULL, NULL);
+        automationRequestSize = 0;
+    }
+    while (automationClient >= 0)
+    {
+        const ssize_t count = recv(automationClient, (unsigned char *)&automationRequest + automationRequestSize, sizeof(automationRequest) - automationRequestSize, MSG_DONTWAIT);
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            return;
+        if (count > 0)
+            automationRequestSize += count;
+        if (count > 0 && automationRequestSize < (int)sizeof(automationRequest))
+            continue;
+        AutomationReply reply = { 0 };
+        if (count > 0)
+            ExecuteAutomationRequest(automationRequest, &reply);
+        automationRequestSize = 0;
+        if (count > 0 && automationStepTicks > 0)
+        {
+            automationStepReply = reply;
+            return;
+        }
+        if (count <= 0 || send(automationClient, &reply, sizeof(reply), 0) != (ssize_t)sizeof(reply))
+        {
+            close(automationClient);
+            automationClient = -1;
+        }
+    }
+#endif
+}
+
+void ExecuteAutomationRequest(AutomationRequest request, AutomationReply *reply)
+{
+    SelectInstance(0);
+    reply->command = request.command;
+    reply->accepted = true;
+    if (request.command == pauseCommand)
+    {
+        automationPaused = true;
+    }
+    else if (request.command == resumeCommand)
+    {
+        automationPaused = false;
+    }
+    else if (request.command == stepCommand)
+    {
+        automationStepTicks = request.argument;
+    }
+    else if (request.command == inputCommand)
+    {
+        automationInput = request.argument & allInputs;
+    }
+    else if ((request.command == seedCommand || request.command == waveCommand) && (replayRecordFile != NULL || replayPlaying))
+    {
+        reply->accepted = false;
+    }
+    else if (request.command == seedCommand)
+    {
+        SeedRandom(request.argument);
+    }
+    else if (request.command == waveCommand)
+    {
+        ResetGame();
+        wave = Clamp(request.argument, 1, MAX_BALANCE_WAVE_COUNT);
+        frameTime = tickTime;
+        ChangeGameState(playState);
+    }
+    else if (request.command == stateCommand)
+    {
+        const int bulletCount = CountEntities(playerBulletArchetype) + CountEntities(alienBulletArchetype);
+        const unsigned int values[AUTOMATION_VALUE_COUNT] = { timerTick, gameState, wave, score, livesRemaining, alienCount, bulletCount, playerPositions[0].x, playerAlive[0], input, randomState, automationPaused };
+        memcpy(reply->values, values, sizeof(values));
+    }
+    else if (request.command == countersCommand)
+    {
+        const unsigned int values[AUTOMATION_VALUE_COUNT] = { profiledFrameCount, profiledTickCount, updateNanoseconds, updateMaxNanoseconds, drawNanoseconds, drawMaxNanoseconds, atomic_load(&mixerCallbackCount), atomic_load(&mixerLastNanoseconds), atomic_load(&mixerMaxNanoseconds), alienExtent, playerBulletExtent + alienBulletExtent, emitterExtent };
+        memcpy(reply->values, values, sizeof(values));
+    }
+    else
+    {
+        reply->accepted = false;
+    }
+}
+
+void CloseAutomation()
+{
+#if !defined(_WIN32)
+    if (automationClient >= 0)
+        close(automationClient);
+    if (automationListener >= 0)
+        close(automationListener);
+    if (automationPath != NULL)
+        unlink(automationPath);
+    automationClient = -1;
+    automationListener = -1;
+    automationPath = NULL;
+#endif
+}
+
+bool LoadBot(const char *path)
+{
+#if defined(_WIN32)
+    fprintf(stderr, "bot plugins require dlopen\n");
+    return false;
+#else
+    UnloadBot();
+    botLibrary = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (botLibrary == NULL)
+    {
+        fprintf(stderr, "bot: %s\n", dlerror());
+        return false;
+    }
+    SpaceInvadersBotAbiVersionFunction abiVersion;
+    *(void **)&abiVersion = dlsym(botLibrary, "SpaceInvadersBotAbiVersion");
+    *(void **)&botUpdate = dlsym(botLibrary, "SpaceInvadersBotUpdate");
+    *(void **)&botShutdown = dlsym(botLibrary, "SpaceInvadersBotShutdown");
+    if (abiVersion == NULL || abiVersion() != SPACE_INVADERS_BOT_ABI_VERSION || botUpdate == NULL)
+    {
+        fprintf(stderr, "bot %s: missing entry points or ABI version is not %d\n", path, SPACE_INVADERS_BOT_ABI_VERSION);
+        botShutdown = NULL;
+        UnloadBot();
+        return false;
+    }
+    botCallCount = 0;
+    botLastNanoseconds = 0;
+    botMaxNanoseconds = 0;
+    botTotalNanoseconds = 0;
+    botOverBudgetCount = 0;
+    return true;
+#endif
+}
+
+unsigned int UpdateBot()
+{
+    const SpaceInvadersBotView view = {
+        SPACE_INVADERS_BOT_ABI_VERSION, timerTick, gameState, wave, score, livesRemaining,
+        { cameraBounds.x, cameraBounds.y }, { cameraBounds.width, cameraBounds.height }, playerSpeed,
+        playerAlive[0], { playerPositions[0].x, playerPositions[0].y }, { playerWidth, playerHalfHeight * 2 }, { alienWidth, alienHeight },
+        alienExtent, (const uint8_t *)alienAlive, (const SpaceInvadersBotVector *)alienPositions,
+        playerBulletExtent, (const uint8_t *)playerBulletAlive, (const SpaceInvadersBotVector *)playerBulletPositions, (const SpaceInvadersBotVector *)playerBulletVelocities, playerBulletRadii,
+        alienBulletExtent, (const uint8_t *)alienBulletAlive, (const SpaceInvadersBotVector *)alienBulletPositions, (const SpaceInvadersBotVector *)alienBulletVelocities, alienBulletRadii
+    };
+    const double start = GetTimestamp();
+    const unsigned int keys = botUpdate(&view);
+    botLastNanoseconds = (GetTimestamp() - start) * 1e9;
+    if (botLastNanoseconds > botMaxNanoseconds)
+        botMaxNanoseconds = botLastNanoseconds;
+    botTotalNanoseconds += botLastNanoseconds;
+    ++botCallCount;
+    if (botLastNanoseconds > botBudgetNanoseconds && botOverBudgetCount++ == 0)
+        fprintf(stderr, "bot exceeded its %.2fus budget at tick %u (%.2fus)\n", botBudgetNanoseconds / 1000.0, timerTick, botLastNanoseconds / 1000.0);
+    return keys & (leftInput | rightInput | shootInput | shootHeldInput);
+}
+
+void PrintBotReport()
+{
+    if (botUpdate == NULL)
+        return;
+    printf("bot: %u calls, last %.2fus, mean %.2fus, max %.2fus, %u over the %.2fus budget\n", botCallCount, botLastNanoseconds / 1000.0, botCallCount > 0 ? botTotalNanoseconds / 1000.0 / botCallCount : 0, botMaxNanoseconds / 1000.0, botOverBudgetCount, botBudgetNanoseconds / 1000.0);
+}
+
+void UnloadBot()
+{
+#if !defined(_WIN32)
+    if (botLibrary == NULL)
+        return;
+    PrintBotReport();
+    if (botShutdown != NULL)
+        botShutdown();
+    dlclose(botLibrary);
+    botLibrary = NULL;
+    botUpdate = NULL;
+    botShutdown = NULL;
+#endif
+}
+
+bool StartCapture()
+{
+    if (captureFrames == NULL)
+    {
+        captureFrames = RL_MALLOC(CAPTURE_FRAME_COUNT * captureWidth * captureHeight * 4);
+        captureIndices = RL_MALLOC(captureWidth * captureHeight);
+        if (captureFrames == NULL || captureIndices == NULL)
+        {
+            RL_FREE(captureFrames);
+            RL_FREE(captureIndices);
+            captureFrames = NULL;
+            captureIndices = NULL;
+            return false;
+        }
+        BuildCapturePalette();
+#if defined(_WIN32)
+        BuildCaptureLookup();
+#else
+        if (pthread_create(&captureThread, NULL, RunCaptureEncoder, NULL) != 0)
+        {
+            RL_FREE(captureFrames);
+            RL_FREE(captureIndices);
+            captureFrames = NULL;
+            captureIndices = NULL;
+            return false;
+        }
+#endif
+    }
+    captureSessionFirst = captureWrittenFrames;
+    captureClock = 0;
+    LoadReadbackTargets(&captureTargets, captureWidth, captureHeight);
+    captureActive = true;
+    return true;
+}
+
+void CaptureFrame()
+{
+    if (!captureActive)
+        return;
+    Image frame;
+    while (ReadReadbackTarget(&captureTargets, &frame) >= 0)
+    {
+        StoreCaptureFrame(frame);
+        UnloadImage(frame);
+    }
+    captureClock += GetFrameTime();
+    if (captureClock < 1.0f / captureFrameRate)
+        return;
+    captureClock = fmodf(captureClock, 1.0f / captureFrameRate);
+    SelectInstance(0);
+    if (!BeginReadbackTarget(&captureTargets))
+        return;
+    const Camera2D screenCamera = camera;
+    camera.offset = Vector2Scale(camera.offset, 1 / cameraZoom);
+    camera.zoom /= cameraZoom;
+    ClearBackground(BLACK);
+    DrawWorld();
+    EndReadbackTarget(&captureTargets);
+    camera = screenCamera;
+}
+
+void StoreCaptureFrame(Image frame)
+{
+    const unsigned int overwritten = captureWrittenFrames - CAPTURE_FRAME_COUNT;
+    if (atomic_load(&captureEncoding) && captureWrittenFrames >= CAPTURE_FRAME_COUNT && overwritten >= atomic_load(&captureEncodedFrame) && overwritten < captureClipLast)
+        return;
+    memcpy(captureFrames + (captureWrittenFrames % CAPTURE_FRAME_COUNT) * captureWidth * captureHeight * 4, frame.data, captureWidth * captureHeight * 4);
+    ++captureWrittenFrames;
+}
+
+void SaveCapture()
+{
+    if (!captureActive || captureWrittenFrames == captureSessionFirst || atomic_load(&captureEncoding))
+        return;
+    const time_t now = time(NULL);
+    strftime(capturePath, sizeof(capturePath), "Capture_%Y%m%d_%H%M%S.gif", localtime(&now));
+    captureClipFirst = captureWrittenFrames - captureSessionFirst > CAPTURE_FRAME_COUNT ? captureWrittenFrames - CAPTURE_FRAME_COUNT : captureSessionFirst;
+    captureClipLast = captureWrittenFrames;
+    atomic_store(&captureEncodedFrame, captureClipFirst);
+    atomic_store(&captureEncoding, true);
+#if defined(_WIN32)
+    EncodeCapture();
+#else
+    pthread_mutex_lock(&captureMutex);
+    pthread_cond_signal(&captureCondition);
+    pthread_mutex_unlock(&captureMutex);
+#endif
+}
+
+void StopCapture()
+{
+    if (!captureActive)
+        return;
+    captureActive = false;
+    UnloadReadbackTargets(&captureTargets);
+}
+
+void CloseCapture()
+{
+    StopCapture();
+    if (captureFrames == NULL)
+        return;
+#if !defined(_WIN32)
+    pthread_mutex_lock(&captureMutex);
+    captureStopping = true;
+    pthread_cond_signal(&captureCondition);
+    pthread_mutex_unlock(&captureMutex);
+    pthread_join(captureThread, NULL);
+#endif
+    RL_FREE(captureFrames);
+    RL_FREE(captureIndices);
+    captureFrames = NULL;
+    captureIndices = NULL;
+}
+
+void BuildCapturePalette()
+{
+    static const char *spritePaths[3] = { "Player.png", "Alien.png", "Ufo.png" };
+    capturePaletteSize = 0;
+    AddCaptureColor(BLACK);
+    AddCaptureColor(RED);
+    AddCaptureColor(shieldColor);
+    AddCaptureColor(playerBulletColor);
+    AddCaptureColor(alienBulletColor);
+    AddCaptureColor(playerMissileColor);
+    for (int i = 0; i < POWER_UP_COUNT; ++i)
+    {
+        AddCaptureColor(powerUps[i].color);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        Image sprite = LoadImage(spritePaths[i]);
+        Color *colors = LoadImageColors(sprite);
+        for (int j = 0; colors != NULL && j < sprite.width * sprite.height; ++j)
+        {
+            if (colors[j].a > 0)
+                AddCaptureColor(colors[j]);
+        }
+        UnloadImageColors(colors);
+        UnloadImage(sprite);
+    }
+    for (int i = 0; i < 216; ++i)
+    {
+        AddCaptureColor((Color) { i / 36 * 51, i / 6 % 6 * 51, i % 6 * 51, 255 });
+    }
+}
+
+void AddCaptureColor(Color color)
+{
+    for (int i = 0; i < capturePaletteSize; ++i)
+    {
+        if (capturePalette[i].r == color.r && capturePalette[i].g == color.g && capturePalette[i].b == color.b)
+            return;
+    }
+    if (capturePaletteSize < CAPTURE_PALETTE_SIZE)
+        capturePalette[capturePaletteSize++] = (Color) { color.r, color.g, color.b, 255 };
+}
+
+void BuildCaptureLookup()
+{
+    for (int i = 0; i < CAPTURE_LOOKUP_SIZE; ++i)
+    {
+        const int r = (i >> 10 & 31) * 255 / 31;
+        const int g = (i >> 5 & 31) * 255 / 31;
+        const int b = (i & 31) * 255 / 31;
+        int bestDistance = INT_MAX;
+        for (int j = 0; j < capturePaletteSize; ++j)
+        {
+            const int dr = capturePalette[j].r - r;
+            const int dg = capturePalette[j].g - g;
+            const int db = capturePalette[j].b - b;
+            const int distance = dr * dr + dg * dg + db * db;
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                captureLookup[i] = j;
+            }
+        }
+    }
+}
+
+#if !defined(_WIN32)
+void *RunCaptureEncoder(void *argument)
+{
+    (void)argument;
+    BuildCaptureLookup();
+    for (;;)
+    {
+        pthread_mutex_lock(&captureMutex);
+        while (!captureStopping && !atomic_load(&captureEncoding))
+        {
+            pthread_cond_wait(&captureCondition, &captureMutex);
+        }
+        pthread_mutex_unlock(&captureMutex);
+        if (!atomic_load(&captureEncoding))
+            return NULL;
+        EncodeCapture();
+    }
+}
+#endif
+
+void EncodeCapture()
+{
+    FILE *file = fopen(capturePath, "wb");
+    if (file != NULL)
+    {
+        fwrite("GIF89a", 1, 6, file);
+        WriteGifWord(file, captureWidth);
+        WriteGifWord(file, captureHeight);
+        fputc(0xF7, file);
+        fputc(0, file);
+        fputc(0, file);
+        for (int i = 0; i < CAPTURE_PALETTE_SIZE; ++i)
+        {
+            fputc(capturePalette[i].r, file);
+            fputc(capturePalette[i].g, file);
+            fputc(capturePalette[i].b, file);
+        }
+        fwrite("\x21\xFF\x0BNETSCAPE2.0\x03\x01\x00\x00\x00", 1, 19, file);
+        for (unsigned int frame = captureClipFirst; frame < captureClipLast; ++frame)
+        {
+            const unsigned char *pixels = captureFrames + (frame % CAPTURE_FRAME_COUNT) * captureWidth * captureHeight * 4;
+            for (int y = 0; y < captureHeight; ++y)
+            {
+                const unsigned char *row = pixels + (captureHeight - 1 - y) * captureWidth * 4;
+                unsigned char *indices = captureIndices + y * captureWidth;
+                for (int x = 0; x < captureWidth; ++x)
+                {
+                    indices[x] = captureLookup[(row[x * 4] >> 3) << 10 | (row[x * 4 + 1] >> 3) << 5 | row[x * 4 + 2] >> 3];
+                }
+            }
+            atomic_store(&captureEncodedFrame, frame + 1);
+            fwrite("\x21\xF9\x04\x00", 1, 4, file);
+            WriteGifWord(file, 100 / captureFrameRate);
+            fwrite("\x00\x00\x2C\x00\x00\x00\x00", 1, 7, file);
+            WriteGifWord(file, captureWidth);
+            WriteGifWord(file, captureHeight);
+            fputc(0, file);
+            EncodeGifFrame(file, captureIndices, captureWidth * captureHeight);
+        }
+        fputc(0x3B, file);
+        fclose(file);
+        printf("capture: %u frames saved to %s\n", captureClipLast - captureClipFirst, capturePath);
+    }
+    atomic_store(&captureEncoding, false);
+}
+
+void EncodeGifFrame(FILE *file, const unsigned char *indices, int count)
+{
+    const int clearCode = 1 << gifMinimumCodeSize;
+    GifBitWriter writer = { file, 0, 0, { 0 }, 0 };
+    int codeSize = gifMinimumCodeSize + 1;
+    int maxCode = clearCode + 1;
+    fputc(gifMinimumCodeSize, file);
+    memset(captureLzwKeys, 0, sizeof(captureLzwKeys));
+    WriteGifCode(&writer, clearCode, codeSize);
+    int prefix = indices[0];
+    for (int i = 1; i < count; ++i)
+    {
+        const unsigned int key = ((unsigned int)prefix << 8 | indices[i]) + 1;
+        unsigned int slot = (key * 2654435761u) >> (32 - CAPTURE_LZW_HASH_BITS);
+        while (captureLzwKeys[slot] != 0 && captureLzwKeys[slot] != key)
+        {
+            slot = (slot + 1) & (CAPTURE_LZW_HASH_SIZE - 1);
+        }
+        if (captureLzwKeys[slot] == key)
+        {
+            prefix = captureLzwCodes[slot];
+            continue;
+        }
+        WriteGifCode(&writer, prefix, codeSize);
+        captureLzwKeys[slot] = key;
+        captureLzwCodes[slot] = ++maxCode;
+        if (maxCode >= 1 << codeSize)
+            ++codeSize;
+        if (maxCode == gifMaxCode)
+        {
+            WriteGifCode(&writer, clearCode, codeSize);
+            memset(captureLzwKeys, 0, sizeof(captureLzwKeys));
+            codeSize = gifMinimumCodeSize + 1;
+            maxCode = clearCode + 1;
+        }
+        prefix = indices[i];
+    }
+    WriteGifCode(&writer, prefix, codeSize);
+    WriteGifCode(&writer, clearCode + 1, codeSize);
+    if (writer.bitCount > 0)
+        WriteGifCode(&writer, 0, 8 - writer.bitCount);
+    FlushGifBlock(&writer);
+    fputc(0, file);
+}
+
+void WriteGifCode(GifBitWriter *writer, int code, int codeSize)
+{
+    writer->bits |= (unsigned int)code << writer->bitCount;
+    writer->bitCount += codeSize;
+    while (writer->bitCount >= 8)
+    {
+        writer->block[writer->blockSize++] = writer->bits & 0xFF;
+        writer->bits >>= 8;
+        writer->bitCount -= 8;
+        if (writer->blockSize == 255)
+            FlushGifBlock(writer);
+    }
+}
+
+void FlushGifBlock(GifBitWriter *writer)
+{
+    if (writer->blockSize == 0)
+        return;
+    fputc(writer->blockSize, writer->file);
+    fwrite(writer->block, 1, writer->blockSize, writer->file);
+    writer->blockSize = 0;
+}
+
+void WriteGifWord(FILE *file, int value)
+{
+    fputc(value & 0xFF, file);
+    fputc(value >> 8 & 0xFF, file);
+}
+
+void LoadReadbackTargets(ReadbackTargets *readback, int width, int height)
+{
+    for (int i = 0; i < READBACK_TARGET_COUNT; ++i)
+    {
+        readback->targets[i] = LoadRenderTexture(width, height);
+        readback->pending[i] = false;
+    }
+    readback->next = 0;
+}
+
+void UnloadReadbackTargets(ReadbackTargets *readback)
+{
+    for (int i = 0; i < READBACK_TARGET_COUNT; ++i)
+    {
+        if (readback->targets[i].id != 0)
+            UnloadRenderTexture(readback->targets[i]);
+        readback->targets[i] = (RenderTexture2D) { 0 };
+        readback->pending[i] = false;
+    }
+}
+
+bool BeginReadbackTarget(ReadbackTargets *readback)
+{
+    if (readback->pending[readback->next])
+        return false;
+    BeginTextureMode(readback->targets[readback->next]);
+    return true;
+}
+
+void EndReadbackTarget(ReadbackTargets *readback)
+{
+    EndTextureMode();
+    readback->pending[readback->next] = true;
+    readback->next = (readback->next + 1) % READBACK_TARGET_COUNT;
+}
+
+int ReadReadbackTarget(ReadbackTargets *readback, Image *image)
+{
+    for (int i = 0; i < READBACK_TARGET_COUNT; ++i)
+    {
+        const int target = (readback->next + i) % READBACK_TARGET_COUNT;
+        if (!readback->pending[target])
+            continue;
+        readback->pending[target] = false;
+        *image = LoadImageFromTexture(readback->targets[target].texture);
+        return target;
+    }
+    return -1;
+}
+
+bool StartScreenshotWriter()
+{
+#if !defined(_WIN32)
+    screenshotStopping = false;
+    if (pthread_create(&screenshotThread, NULL, RunScreenshotWriter, NULL) != 0)
+        return false;
+#endif
+    screenshotReady = true;
+    return true;
+}
+
+void RequestScreenshot()
+{
+    if (!screenshotReady || screenshotRequested)
+        return;
+    if (screenshotTargets.targets[0].id == 0)
+        LoadReadbackTargets(&screenshotTargets, screenWidth, screenHeight);
+    if (screenshotTargets.pending[screenshotTargets.next])
+        return;
+    const time_t now = time(NULL);
+    char stamp[16];
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&now));
+    snprintf(screenshotPaths[screenshotTargets.next], sizeof(screenshotPaths[screenshotTargets.next]), "Screenshot_%s_%03u.png", stamp, screenshotCount++ % 1000);
+    screenshotRequested = true;
 }
 
-void UpdateReadyState()
+void ReadScreenshots()
 {
-    readyElapsed += frameTime;
-    if (readyElapsed > delayThreshold)
+    Image image;
+    int target;
+    while ((target = ReadReadbackTarget(&screenshotTargets, &image)) >= 0)
     {
-        FromReadyToPlayState();
+        ScreenshotJob job = { image, { 0 } };
+        memcpy(job.path, screenshotPaths[target], sizeof(job.path));
+#if defined(_WIN32)
+        WriteScreenshot(&job);
+#else
+        pthread_mutex_lock(&screenshotMutex);
+        if (screenshotQueueHead - screenshotQueueTail < SCREENSHOT_QUEUE_SIZE)
+        {
+            screenshotQueue[screenshotQueueHead % SCREENSHOT_QUEUE_SIZE] = job;
+            ++screenshotQueueHead;
+            pthread_cond_signal(&screenshotCondition);
+        }
+        else
+        {
+            fprintf(stderr, "screenshot: writer busy, dropped %s\n", job.path);
+            UnloadImage(job.image);
+        }
+        pthread_mutex_unlock(&screenshotMutex);
+#endif
     }
 }
 
-void UpdatePlayState()
+void WriteScreenshot(ScreenshotJob *job)
+{
+    ImageFlipVertical(&job->image);
+    if (ExportImage(job->image, job->path))
+        printf("screenshot: saved %s\n", job->path);
+    UnloadImage(job->image);
+}
+
+#if !defined(_WIN32)
+void *RunScreenshotWriter(void *argument)
 {
-    if (IsKeyDown(KEY_A))
+    (void)argument;
+    pthread_mutex_lock(&screenshotMutex);
+    for (;;)
     {
-        player.position.x -= playerSpeed;
-        if (player.position.x < cameraBounds.x)
+        while (!screenshotStopping && screenshotQueueTail == screenshotQueueHead)
         {
-            player.position.x = cameraBounds.x;
+            pthread_cond_wait(&screenshotCondition, &screenshotMutex);
         }
+        if (screenshotQueueTail == screenshotQueueHead)
+            break;
+        ScreenshotJob job = screenshotQueue[screenshotQueueTail % SCREENSHOT_QUEUE_SIZE];
+        ++screenshotQueueTail;
+        pthread_mutex_unlock(&screenshotMutex);
+        WriteScreenshot(&job);
+        pthread_mutex_lock(&screenshotMutex);
+    }
+    pthread_mutex_unlock(&screenshotMutex);
+    return NULL;
+}
+#endif
+
+void StopScreenshotWriter()
+{
+    if (!screenshotReady)
+        return;
+    ReadScreenshots();
+    screenshotReady = false;
+#if !defined(_WIN32)
+    pthread_mutex_lock(&screenshotMutex);
+    screenshotStopping = true;
+    pthread_cond_signal(&screenshotCondition);
+    pthread_mutex_unlock(&screenshotMutex);
+    pthread_join(screenshotThread, NULL);
+#endif
+    UnloadReadbackTargets(&screenshotTargets);
+}
+
+void TraceStartupPhase(const char *name)
+{
+    const double now = GetTimestamp();
+    if (startupPhaseCount < MAX_STARTUP_PHASE_COUNT)
+    {
+        snprintf(startupPhases[startupPhaseCount].name, sizeof(startupPhases[startupPhaseCount].name), "%s", name);
+        startupPhases[startupPhaseCount].seconds = now - startupPhaseStart;
+        ++startupPhaseCount;
+    }
+    startupPhaseStart = now;
+}
+
+void PrintStartupReport()
+{
+    double totalSeconds = 0;
+    printf("startup phases:\n");
+    for (int i = 0; i < startupPhaseCount; ++i)
+    {
+        printf("  %-32s %9.3f ms\n", startupPhases[i].name, startupPhases[i].seconds * 1000);
+        totalSeconds += startupPhases[i].seconds;
+    }
+    printf("  %-32s %9.3f ms\n", "total", totalSeconds * 1000);
+    long totalBytes = 0;
+    long bytes = GetPixelDataSize(playerTexture.width, playerTexture.height, playerTexture.format);
+    printf("memory budget:\n  %-32s %9ld bytes\n", "texture Player.png", bytes);
+    totalBytes += bytes;
+    bytes = GetPixelDataSize(alienTexture.width, alienTexture.height, alienTexture.format);
+    printf("  %-32s %9ld bytes\n", "texture Alien.png", bytes);
+    totalBytes += bytes;
+    bytes = GetPixelDataSize(ufoTexture.width, ufoTexture.height, ufoTexture.format);
+    printf("  %-32s %9ld bytes\n", "texture Ufo.png", bytes);
+    totalBytes += bytes;
+    bytes = sizeof(ufoPathPoints) + sizeof(ufoPathSampleCounts);
+    printf("  %-32s %9ld bytes\n", "ufo path tables", bytes);
+    totalBytes += bytes;
+    bytes = sizeof(bulletPatternCode);
+    printf("  %-32s %9ld bytes\n", "bullet pattern bytecode", bytes);
+    totalBytes += bytes;
+    for (int i = 0; i < SOUND_EFFECT_COUNT; ++i)
+    {
+        bytes = soundEffectFrameCounts[i] * sizeof(float);
+        printf("  sound %-26s %9ld bytes\n", soundEffectNames[i], bytes);
+        totalBytes += bytes;
+    }
+    bytes = 2L * mixerBufferFrames * mixerStream.channels * mixerStream.sampleSize / 8 + sizeof(voices) + sizeof(voiceQueue);
+    printf("  %-32s %9ld bytes\n", "mixer stream and voices", bytes);
+    totalBytes += bytes;
+    bytes = 2L * musicStreamBufferFrames * music.stream.channels * music.stream.sampleSize / 8;
+    printf("  %-32s %9ld bytes (est.)\n", "music stream buffers", bytes);
+    totalBytes += bytes;
+    bytes = sizeof(playerAlive) + sizeof(playerGenerations) + sizeof(playerPositions);
+    bytes += sizeof(alienAlive) + sizeof(alienGenerations) + sizeof(alienPositions) + sizeof(alienVelocities) + sizeof(alienTypeIds) + sizeof(alienHitPoints) + sizeof(alienHitFlashes);
+    bytes += sizeof(playerBulletAlive) + sizeof(playerBulletGenerations) + sizeof(playerBulletPositions) + sizeof(playerBulletVelocities) + sizeof(playerBulletHomingRates) + sizeof(playerBulletRadii) + sizeof(playerBulletColors);
+    bytes += sizeof(alienBulletAlive) + sizeof(alienBulletGenerations) + sizeof(alienBulletPositions) + sizeof(alienBulletVelocities) + sizeof(alienBulletAnchors) + sizeof(alienBulletDrifts) + sizeof(alienBulletSprings) + sizeof(alienBulletHomingRates) + sizeof(alienBulletRadii) + sizeof(alienBulletColors) + sizeof(alienBulletOwners);
+    bytes += sizeof(emitterAlive) + sizeof(emitterGenerations) + sizeof(emitterOwners) + sizeof(emitterStates);
+    bytes += sizeof(ufoAlive) + sizeof(ufoGenerations) + sizeof(ufoPositions) + sizeof(ufoPaths) + sizeof(ufoPathTicks);
+    bytes += sizeof(dropAlive) + sizeof(dropGenerations) + sizeof(dropPositions) + sizeof(dropVelocities) + sizeof(dropRadii) + sizeof(dropColors) + sizeof(dropKinds);
+    printf("  %-32s %9ld bytes\n", "entity pools", bytes);
+    totalBytes += bytes;
+    bytes = sizeof(timers) + sizeof(timerSlots);
+    printf("  %-32s %9ld bytes\n", "timer wheel", bytes);
+    totalBytes += bytes;
+    if (instanceCount > 1)
+    {
+        bytes = (long)instanceCount * GetGameStateSize();
+        printf("  %-32s %9ld bytes\n", "split-screen instance states", bytes);
+        totalBytes += bytes;
+    }
+    bytes = (long)instanceCount * GetGameStateSize();
+    printf("  %-32s %9ld bytes\n", "wave snapshots", bytes);
+    totalBytes += bytes;
+    if (screenshotTargets.targets[0].id != 0)
+    {
+        bytes = (long)READBACK_TARGET_COUNT * GetPixelDataSize(screenWidth, screenHeight, screenshotTargets.targets[0].texture.format);
+        printf("  %-32s %9ld bytes (est.)\n", "screenshot targets", bytes);
+        totalBytes += bytes;
     }
-    if (IsKeyDown(KEY_D))
+    printf("  %-32s %9ld bytes\n", "total", totalBytes);
+    printf("resident set: %ld KB before, %ld KB after startup, %ld KB now\n", startupResidentBefore / 1024, startupResidentAfter / 1024, GetResidentBytes() / 1024);
+}
+
+long GetResidentBytes()
+{
+    long residentPages = 0;
+#if defined(__linux__)
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file != NULL)
+    {
+        if (fscanf(file, "%*s %ld", &residentPages) != 1)
+            residentPages = 0;
+        fclose(file);
+    }
+    return residentPages * sysconf(_SC_PAGESIZE);
+#else
+    return residentPages;
+#endif
+}
+
+int RunBalanceAnalyzer(int argc, char *argv[])
+{
+    int firstWave = 1;
+    int lastWave = 20;
+    int trialCount = 10000;
+    int jobCount = 1;
+    unsigned int seed = 1;
+    float maxSeconds = 120;
+    ScriptedPlayer profile = { 6, 12, 2, 24, 0, 0, 0 };
+    BuildUfoPaths();
+    if (!BuildBulletPatterns())
+        return 1;
+#if !defined(_WIN32)
+    jobCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    for (int i = 0; i < argc; ++i)
     {
-        player.position.x += playerSpeed;
-        if (player.position.x > cameraBounds.x + cameraBounds.width - playerWidth)
+        if (strcmp(argv[i], "--first-wave") == 0 && i + 1 < argc)
+            firstWave = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--last-wave") == 0 && i + 1 < argc)
+            lastWave = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--trials") == 0 && i + 1 < argc)
+            trialCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+            jobCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--max-seconds") == 0 && i + 1 < argc)
+            maxSeconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--reaction") == 0 && i + 1 < argc)
+            profile.reactionTicks = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fire-cooldown") == 0 && i + 1 < argc)
+            profile.fireCooldownTicks = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--aim-error") == 0 && i + 1 < argc)
+            profile.aimError = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--dodge") == 0 && i + 1 < argc)
+            profile.dodgeDistance = atoi(argv[++i]);
+        else
         {
-            player.position.x = cameraBounds.x + cameraBounds.width - playerWidth;
+            fprintf(stderr, "usage: SpaceInvaders --balance [--first-wave N] [--last-wave N] [--trials N] [--jobs N] [--seed N] [--max-seconds S] [--reaction TICKS] [--fire-cooldown TICKS] [--aim-error PIXELS] [--dodge PIXELS]\n");
+            return 1;
         }
     }
-    if (IsKeyPressed(KEY_ENTER))
+    const int maxTicks = Clamp(maxSeconds / tickTime, 1, MAX_BALANCE_TICK_COUNT);
+    firstWave = Clamp(firstWave, 1, MAX_BALANCE_WAVE_COUNT);
+    lastWave = Clamp(lastWave, firstWave, firstWave + MAX_BALANCE_WAVE_COUNT - 1);
+    jobCount = Clamp(jobCount, 1, MAX_BALANCE_JOB_COUNT);
+    profile.reactionTicks = profile.reactionTicks > 1 ? profile.reactionTicks : 1;
+    const int waveCount = lastWave - firstWave + 1;
+    const size_t resultsSize = sizeof(BalanceWaveResult) * waveCount;
+    BalanceWaveResult *totals = calloc(waveCount, sizeof(BalanceWaveResult));
+    BalanceWaveResult *results = calloc(waveCount, sizeof(BalanceWaveResult));
+    if (totals == NULL || results == NULL)
     {
-        ShootPlayerBullet();
+        fprintf(stderr, "balance: out of memory\n");
+        return 1;
     }
-    UpdateAlienAnimations();
-    int newAlienDirection = alienDirection;
-    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+    const time_t startTime = time(NULL);
+#if defined(_WIN32)
+    jobCount = 1;
+    SimulateBalanceTrials(firstWave, lastWave, trialCount, 0, 1, seed, profile, maxTicks, totals);
+#else
+    int pipes[MAX_BALANCE_JOB_COUNT];
+    pid_t jobs[MAX_BALANCE_JOB_COUNT];
+    for (int job = 0; job < jobCount; ++job)
     {
-        if (aliens[i].alive)
+        int fds[2];
+        if (pipe(fds) != 0 || (jobs[job] = fork()) < 0)
+        {
+            fprintf(stderr, "balance: could not start job %d\n", job);
+            return 1;
+        }
+        if (jobs[job] == 0)
         {
-            if (alienDirection == 0)
+            close(fds[0]);
+            SimulateBalanceTrials(firstWave, lastWave, trialCount, job, jobCount, seed, profile, maxTicks, results);
+            const char *data = (const char *)results;
+            for (size_t written = 0; written < resultsSize;)
             {
-                aliens[i].position.x += alienSpeed;
-                if (aliens[i].position.x > cameraBounds.x + cameraBounds.width - alienWidth)
-                {
-                    newAlienDirection = 1;
-                }
+                const ssize_t count = write(fds[1], data + written, resultsSize - written);
+                if (count <= 0)
+                    _exit(1);
+                written += count;
             }
-            else if (alienDirection == 1)
+            _exit(0);
+        }
+        close(fds[1]);
+        pipes[job] = fds[0];
+    }
+    for (int job = 0; job < jobCount; ++job)
+    {
+        char *data = (char *)results;
+        size_t received = 0;
+        while (received < resultsSize)
+        {
+            const ssize_t count = read(pipes[job], data + received, resultsSize - received);
+            if (count <= 0)
+                break;
+            received += count;
+        }
+        close(pipes[job]);
+        int status = 0;
+        waitpid(jobs[job], &status, 0);
+        if (received < resultsSize || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            fprintf(stderr, "balance: job %d failed\n", job);
+            return 1;
+        }
+        for (int w = 0; w < waveCount; ++w)
+        {
+            totals[w].trialCount += results[w].trialCount;
+            totals[w].clearCount += results[w].clearCount;
+            totals[w].timeoutCount += results[w].timeoutCount;
+            for (int tick = 0; tick < maxTicks; ++tick)
             {
-                aliens[i].position.x -= alienSpeed;
-                if (aliens[i].position.x < cameraBounds.x)
-                {
-                    newAlienDirection = 0;
-                }
+                totals[w].clearTicks[tick] += results[w].clearTicks[tick];
+            }
+        }
+    }
+#endif
+    printf("wave,rows,fireOdds,trials,survival,timeouts,clearMean,clearP10,clearP50,clearP90,clearMax\n");
+    for (int w = 0; w < waveCount; ++w)
+    {
+        const BalanceWaveResult *result = &totals[w];
+        double tickSum = 0;
+        int maxClear = 0;
+        for (int tick = 0; tick < maxTicks; ++tick)
+        {
+            tickSum += (double)result->clearTicks[tick] * (tick + 1);
+            if (result->clearTicks[tick] > 0)
+                maxClear = tick + 1;
+        }
+        const double survival = result->trialCount > 0 ? (double)result->clearCount / result->trialCount : 0;
+        const double mean = result->clearCount > 0 ? tickSum / result->clearCount * tickTime : 0;
+        printf("%d,%d,%d,%u,%.4f,%u,%.2f,%.2f,%.2f,%.2f,%.2f\n", firstWave + w, GetWaveRowCount(firstWave + w), GetWaveFireOdds(firstWave + w), result->trialCount, survival, result->timeoutCount, mean,
+            GetHistogramPercentile(result->clearTicks, maxTicks, result->clearCount, 0.1f) * tickTime,
+            GetHistogramPercentile(result->clearTicks, maxTicks, result->clearCount, 0.5f) * tickTime,
+            GetHistogramPercentile(result->clearTicks, maxTicks, result->clearCount, 0.9f) * tickTime,
+            maxClear * tickTime);
+    }
+    fprintf(stderr, "balance: %d waves x %d trials on %d jobs in %lds\n", waveCount, trialCount, jobCount, (long)(time(NULL) - startTime));
+    free(results);
+    free(totals);
+    return 0;
+}
+
+void SimulateBalanceTrials(int firstWave, int lastWave, int trialCount, int jobIndex, int jobCount, unsigned int seed, ScriptedPlayer profile, int maxTicks, BalanceWaveResult *results)
+{
+    for (int trialWave = firstWave; trialWave <= lastWave; ++trialWave)
+    {
+        BalanceWaveResult *result = &results[trialWave - firstWave];
+        for (int trial = jobIndex; trial < trialCount; trial += jobCount)
+        {
+            ScriptedPlayer trialProfile = profile;
+            SeedRandom(HashSeed(seed, trialWave, trial));
+            const int ticks = SimulateBalanceTrial(trialWave, &trialProfile, maxTicks);
+            ++result->trialCount;
+            if (ticks > 0)
+            {
+                ++result->clearCount;
+                ++result->clearTicks[ticks - 1];
             }
-            if (GetRandomValue(1, Clamp(300 - (wave - 1) * 10, 120, 300)) == 1)
+            else if (ticks == 0)
             {
-                ShootAlienBullet(i);
+                ++result->timeoutCount;
             }
         }
     }
-    alienDirection = newAlienDirection;
-    for (int i = 0; i < MAX_BULLET_COUNT; ++i)
+}
+
+int SimulateBalanceTrial(int trialWave, ScriptedPlayer *profile, int maxTicks)
+{
+    ResetGame();
+    wave = trialWave;
+    frameTime = tickTime;
+    ChangeGameState(playState);
+    profile->targetX = playerPositions[0].x + playerHalfWidth;
+    profile->reactionElapsed = profile->reactionTicks;
+    profile->fireElapsed = profile->fireCooldownTicks;
+    for (int tick = 0; tick < maxTicks; ++tick)
+    {
+        input = UpdateScriptedPlayer(profile);
+        UpdateSimulation();
+        if (gameState == winState)
+            return tick + 1;
+        if (gameState == loseState)
+            return -1;
+    }
+    return 0;
+}
+
+unsigned int UpdateScriptedPlayer(ScriptedPlayer *profile)
+{
+    unsigned int keys = 0;
+    const float playerCenter = playerPositions[0].x + playerHalfWidth;
+    if (++profile->reactionElapsed >= profile->reactionTicks)
     {
-        if (bullets[i].active)
+        profile->reactionElapsed = 0;
+        float nearestDistance = cameraBounds.width;
+        for (int i = 0; i < alienExtent; ++i)
         {
-            if (bullets[i].belongsToPlayer)
+            if (alienAlive[i] && fabsf(alienPositions[i].x + alienHalfWidth - playerCenter) < nearestDistance)
             {
-                bullets[i].position.y -= playerBulletSpeed;
-                for (int j = 0; j < MAX_ALIEN_COUNT; ++j)
-                {
-                    if (aliens[j].alive)
-                    {
-                        if (CheckCollisionCircles(bullets[i].position, playerBulletRadius, (Vector2) { aliens[j].position.x + alienHalfWidth, aliens[j].position.y + alienHalfHeight }, alienHalfWidth))
-                        {
-                            bullets[i].active = false;
-                            aliens[j].alive = false;
-                            --alienCount;
-                            PlaySound(alienDeathSound);
-                            if (alienCount == 0)
-                            {
-                                FromPlayToWinState();
-                                return;
-                            }
-                            break;
-                        }
-                    }
-                }
+                nearestDistance = fabsf(alienPositions[i].x + alienHalfWidth - playerCenter);
+                profile->targetX = alienPositions[i].x + alienHalfWidth + RandomValue(-profile->aimError, profile->aimError);
             }
-            else
+        }
+    }
+    int preferredMove = 0;
+    if (profile->targetX < playerCenter - playerSpeed * 0.5f)
+        preferredMove = -1;
+    else if (profile->targetX > playerCenter + playerSpeed * 0.5f)
+        preferredMove = 1;
+    const int moves[3] = { preferredMove, preferredMove == 0 ? -1 : 0, preferredMove == 1 ? -1 : 1 };
+    int bestMove = preferredMove;
+    int bestDanger = MAX_ALIEN_BULLET_COUNT + 1;
+    for (int m = 0; m < 3 && bestDanger > 0; ++m)
+    {
+        int danger = 0;
+        for (int i = 0; i < alienBulletExtent; ++i)
+        {
+            const float reach = playerHalfWidth + alienBulletRadius + 1;
+            const float playerCenterY = playerPositions[0].y + playerHalfHeight;
+            if (alienBulletAlive[i] && alienBulletDrifts[i].y > 0 && alienBulletPositions[i].y < playerCenterY + reach && alienBulletPositions[i].y > playerCenterY - profile->dodgeDistance)
             {
-                bullets[i].position.y += alienBulletSpeed;
-                if (CheckCollisionCircles(bullets[i].position, alienBulletRadius, (Vector2) { player.position.x + playerHalfWidth, player.position.y + playerHalfHeight }, playerHalfWidth))
-                {
-                    PlaySound(playerDeathSound);
-                    FromPlayToLoseState();
-                    return;
-                }
-                else if (bullets[i].position.y < cameraBounds.y)
-                {
-                    bullets[i].active = false;
-                }
+                const float offset = alienBulletPositions[i].x - alienBulletAnchors[i].x;
+                const float swing = alienBulletVelocities[i].x - alienBulletDrifts[i].x;
+                const float envelope = alienBulletSprings[i].x > 0 ? sqrtf(offset * offset + swing * swing / alienBulletSprings[i].x) : 0;
+                const float firstTick = fmaxf(0, (playerCenterY - reach - alienBulletPositions[i].y) / alienBulletDrifts[i].y);
+                const float lastTick = (playerCenterY + reach - alienBulletPositions[i].y) / alienBulletDrifts[i].y;
+                const float firstX = Clamp(playerCenter + moves[m] * playerSpeed * firstTick, cameraBounds.x + playerHalfWidth, cameraBounds.x + cameraBounds.width - playerHalfWidth);
+                const float lastX = Clamp(playerCenter + moves[m] * playerSpeed * lastTick, cameraBounds.x + playerHalfWidth, cameraBounds.x + cameraBounds.width - playerHalfWidth);
+                const float firstBulletX = alienBulletAnchors[i].x + alienBulletDrifts[i].x * firstTick;
+                const float lastBulletX = alienBulletAnchors[i].x + alienBulletDrifts[i].x * lastTick;
+                if (fminf(firstX, lastX) < fmaxf(firstBulletX, lastBulletX) + reach + envelope && fmaxf(firstX, lastX) > fminf(firstBulletX, lastBulletX) - reach - envelope)
+                    ++danger;
             }
         }
+        if (danger < bestDanger)
+        {
+            bestDanger = danger;
+            bestMove = moves[m];
+        }
     }
+    if (bestMove < 0)
+        keys |= leftInput;
+    else if (bestMove > 0)
+        keys |= rightInput;
+    if (++profile->fireElapsed >= profile->fireCooldownTicks && fabsf(profile->targetX - playerCenter) <= playerHalfWidth)
+    {
+        profile->fireElapsed = 0;
+        keys |= shootInput | shootHeldInput;
+    }
+    return keys;
+}
+
+unsigned int HashSeed(unsigned int seed, unsigned int a, unsigned int b)
+{
+    unsigned int hash = seed ^ (a * 0x9E3779B1u) ^ (b * 0x85EBCA77u);
+    hash ^= hash >> 16;
+    hash *= 0x7FEB352Du;
+    hash ^= hash >> 15;
+    hash *= 0x846CA68Bu;
+    hash ^= hash >> 16;
+    return hash;
 }
 
-void UpdateWinState()
+int GetHistogramPercentile(const unsigned int *histogram, int tickCount, unsigned int total, float percentile)
 {
-    winElapsed += frameTime;
-    if (winElapsed > delayThreshold)
+    const double threshold = total * percentile;
+    double accumulated = 0;
+    for (int tick = 0; tick < tickCount; ++tick)
     {
-        FromWinToReadyState();
+        accumulated += histogram[tick];
+        if (accumulated >= threshold && histogram[tick] > 0)
+            return tick + 1;
     }
+    return 0;
 }
 
-void UpdateLoseState()
+int RunStressSearch(int argc, char *argv[])
 {
-    UpdateAlienAnimations();
-    loseElapsed += frameTime;
-    if (loseElapsed > delayThreshold)
+    static StressCase corpus[MAX_STRESS_CORPUS_COUNT];
+    static StressCase child;
+    int iterations = 2000;
+    int tickCount = 1800;
+    int startWave = 19;
+    int corpusCount = 8;
+    unsigned int seed = (unsigned int)time(NULL);
+    const char *outputPrefix = "StressFixture";
+    const char *fixturePaths[MAX_STRESS_CORPUS_COUNT];
+    int fixtureCount = 0;
+    bool replayOnly = false;
+    BuildUfoPaths();
+    if (!BuildBulletPatterns())
+        return 1;
+    for (int i = 0; i < argc; ++i)
     {
-        if (player.livesRemaining > 1)
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+            tickCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--wave") == 0 && i + 1 < argc)
+            startWave = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--keep") == 0 && i + 1 < argc)
+            corpusCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outputPrefix = argv[++i];
+        else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc && fixtureCount < MAX_STRESS_CORPUS_COUNT)
+            fixturePaths[fixtureCount++] = argv[++i];
+        else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc)
         {
-            FromLoseToReadyState();
+            fprintf(stderr, "stress: at most %d --input fixtures\n", MAX_STRESS_CORPUS_COUNT);
+            return 1;
         }
+        else if (strcmp(argv[i], "--replay") == 0)
+            replayOnly = true;
         else
         {
-            FromLoseToStartState();
+            fprintf(stderr, "usage: SpaceInvaders --stress [--iterations N] [--ticks N] [--wave N] [--keep N] [--seed N] [--out PREFIX] [--input FIXTURE]... [--replay]\n");
+            return 1;
+        }
+    }
+    tickCount = Clamp(tickCount, 1, MAX_STRESS_TICK_COUNT);
+    corpusCount = Clamp(corpusCount, 1, MAX_STRESS_CORPUS_COUNT);
+    for (int i = 0; i < fixtureCount; ++i)
+    {
+        if (!ReadStressFixture(fixturePaths[i], &corpus[i]))
+        {
+            fprintf(stderr, "stress: could not read %s\n", fixturePaths[i]);
+            return 1;
+        }
+    }
+    if (replayOnly)
+    {
+        printf("fixture,seed,wave,ticks,worstTick,worstMicroseconds,worstWorkload\n");
+        for (int i = 0; i < fixtureCount; ++i)
+        {
+            EvaluateStressCase(&corpus[i]);
+            printf("%s,%u,%d,%d,%d,%.2f,%d\n", fixturePaths[i], corpus[i].seed, corpus[i].startWave, corpus[i].tickCount, corpus[i].worstTick, corpus[i].cost * 1e6, corpus[i].worstWorkload);
+        }
+        return 0;
+    }
+    if (fixtureCount > corpusCount)
+    {
+        fprintf(stderr, "stress: keeping %d cases so every --input fixture is used\n", fixtureCount);
+        corpusCount = fixtureCount;
+    }
+    SeedRandom(seed);
+    unsigned int searchState = randomState;
+    for (int i = fixtureCount; i < corpusCount; ++i)
+    {
+        corpus[i].seed = HashSeed(seed, i, 0);
+        corpus[i].startWave = startWave;
+        corpus[i].tickCount = tickCount;
+        RecordScriptedStressCase(&corpus[i]);
+    }
+    for (int i = 0; i < corpusCount; ++i)
+    {
+        corpus[i].inputHash = GetStressCaseHash(&corpus[i]);
+        EvaluateStressCase(&corpus[i]);
+    }
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        randomState = searchState;
+        const int parent = RandomValue(0, corpusCount - 1);
+        const int donor = RandomValue(0, corpusCount - 1);
+        MutateStressCase(&child, &corpus[parent], &corpus[donor]);
+        searchState = randomState;
+        child.inputHash = GetStressCaseHash(&child);
+        bool duplicate = false;
+        for (int i = 0; i < corpusCount && !duplicate; ++i)
+        {
+            duplicate = corpus[i].inputHash == child.inputHash;
+        }
+        if (duplicate)
+            continue;
+        EvaluateStressCase(&child);
+        int weakest = 0;
+        for (int i = 1; i < corpusCount; ++i)
+        {
+            if (corpus[i].cost < corpus[weakest].cost)
+                weakest = i;
+        }
+        if (child.cost > corpus[weakest].cost)
+        {
+            corpus[weakest] = child;
+            fprintf(stderr, "stress: iteration %d kept %.2fus (workload %d at tick %d)\n", iteration, child.cost * 1e6, child.worstWorkload, child.worstTick);
+        }
+    }
+    printf("fixture,seed,wave,ticks,worstTick,worstMicroseconds,worstWorkload\n");
+    for (int i = 0; i < corpusCount; ++i)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s%02d.txt", outputPrefix, i);
+        if (!WriteStressFixture(path, &corpus[i]))
+        {
+            fprintf(stderr, "stress: could not write %s\n", path);
+            return 1;
         }
+        printf("%s,%u,%d,%d,%d,%.2f,%d\n", path, corpus[i].seed, corpus[i].startWave, corpus[i].tickCount, corpus[i].worstTick, corpus[i].cost * 1e6, corpus[i].worstWorkload);
     }
+    return 0;
 }
 
-void UpdateAlienAnimations()
+void RecordScriptedStressCase(StressCase *stressCase)
 {
-    alienFrameElapsed += frameTime;
-    if (alienFrameElapsed > animationThreshold)
+    ScriptedPlayer profile = { 6, 4, 0, 24, 0, 0, 0 };
+    ResetGame();
+    SeedRandom(stressCase->seed);
+    wave = stressCase->startWave;
+    frameTime = tickTime;
+    ChangeGameState(playState);
+    profile.targetX = playerPositions[0].x + playerHalfWidth;
+    for (int tick = 0; tick < stressCase->tickCount; ++tick)
     {
-        alienFrameElapsed = 0;
-        ++alienFrameIndex;
-        alienFrameIndex %= animationFrameCount;
+        input = gameState == playState ? UpdateScriptedPlayer(&profile) : shootHeldInput;
+        stressCase->inputs[tick] = input;
+        UpdateSimulation();
     }
 }
 
-void ShootPlayerBullet()
+void EvaluateStressCase(StressCase *stressCase)
 {
-    bullets[nextAvailableBullet].position = (Vector2) { player.position.x + playerHalfWidth, player.position.y - playerBulletRadius };
-    bullets[nextAvailableBullet].belongsToPlayer = true;
-    bullets[nextAvailableBullet].active = true;
-    ++nextAvailableBullet;
-    nextAvailableBullet %= MAX_BULLET_COUNT;
-    PlaySound(shootSound);
+    static double tickCosts[MAX_STRESS_TICK_COUNT];
+    stressCase->cost = 0;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        ResetGame();
+        SeedRandom(stressCase->seed);
+        wave = stressCase->startWave;
+        frameTime = tickTime;
+        ChangeGameState(playState);
+        for (int tick = 0; tick < stressCase->tickCount; ++tick)
+        {
+            const int playerBullets = CountEntities(playerBulletArchetype);
+            const int alienBullets = CountEntities(alienBulletArchetype);
+            input = stressCase->inputs[tick];
+            const double start = GetTimestamp();
+            UpdateSimulation();
+            const double cost = GetTimestamp() - start;
+            tickCosts[tick] = pass == 0 || cost < tickCosts[tick] ? cost : tickCosts[tick];
+            if (pass == 1 && tickCosts[tick] > stressCase->cost)
+            {
+                stressCase->cost = tickCosts[tick];
+                stressCase->worstTick = tick;
+                stressCase->worstWorkload = playerBullets * alienCount + alienBullets;
+            }
+        }
+    }
 }
 
-void ShootAlienBullet(int alienIndex)
+void MutateStressCase(StressCase *child, const StressCase *parent, const StressCase *donor)
+{
+    *child = *parent;
+    const int mutationCount = RandomValue(1, 4);
+    for (int m = 0; m < mutationCount; ++m)
+    {
+        const int first = RandomValue(0, child->tickCount - 1);
+        const int length = RandomValue(1, Clamp(child->tickCount - first, 1, 240));
+        switch (RandomValue(0, 4))
+        {
+            case 0:
+                for (int tick = first; tick < first + length; ++tick)
+                    child->inputs[tick] ^= 1 << RandomValue(0, 3);
+                break;
+            case 1:
+            {
+                const unsigned char keys = RandomValue(0, 15);
+                for (int tick = first; tick < first + length; ++tick)
+                    child->inputs[tick] = keys;
+                break;
+            }
+            case 2:
+                for (int tick = first; tick < first + length && tick < donor->tickCount; ++tick)
+                    child->inputs[tick] = donor->inputs[tick];
+                break;
+            case 3:
+                for (int tick = first; tick < first + length; ++tick)
+                    child->inputs[tick] = (tick & 1) ? shootInput | shootHeldInput : child->inputs[tick] & ~(shootInput | shootHeldInput);
+                break;
+            default:
+                child->seed = HashSeed(child->seed, first, length);
+                break;
+        }
+    }
+}
+
+bool WriteStressFixture(const char *path, const StressCase *stressCase)
+{
+    static const char digits[] = "0123456789abcdef";
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return false;
+    fprintf(file, "SIFX 1 %u %d %d\n", stressCase->seed, stressCase->startWave, stressCase->tickCount);
+    for (int tick = 0; tick < stressCase->tickCount; ++tick)
+    {
+        fputc(digits[stressCase->inputs[tick] & 15], file);
+        if (tick % 60 == 59 || tick == stressCase->tickCount - 1)
+            fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
+
+bool ReadStressFixture(const char *path, StressCase *stressCase)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+        return false;
+    int version = 0;
+    bool valid = fscanf(file, "SIFX %d %u %d %d", &version, &stressCase->seed, &stressCase->startWave, &stressCase->tickCount) == 4 && version == 1 && stressCase->tickCount > 0 && stressCase->tickCount <= MAX_STRESS_TICK_COUNT;
+    for (int tick = 0; valid && tick < stressCase->tickCount;)
+    {
+        const int c = fgetc(file);
+        if (c >= '0' && c <= '9')
+            stressCase->inputs[tick++] = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            stressCase->inputs[tick++] = c - 'a' + 10;
+        else if (c == EOF)
+            valid = false;
+    }
+    fclose(file);
+    return valid;
+}
+
+unsigned int GetStressCaseHash(const StressCase *stressCase)
+{
+    unsigned int hash = HashSeed(stressCase->seed, stressCase->startWave, stressCase->tickCount);
+    for (int tick = 0; tick < stressCase->tickCount; ++tick)
+    {
+        hash = (hash ^ stressCase->inputs[tick]) * 16777619u;
+    }
+    return hash;
+}
+
+double GetTimestamp()
+{
+#if defined(_WIN32)
+    long long counter;
+    long long frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter / frequency;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+int RunEcsBenchmark(int argc, char *argv[])
+{
+    static ReferenceAlien referenceAliens[MAX_ALIEN_COUNT];
+    static ReferenceBullet referenceBullets[MAX_PLAYER_BULLET_COUNT + MAX_ALIEN_BULLET_COUNT];
+    const int bulletCount = MAX_PLAYER_BULLET_COUNT + MAX_ALIEN_BULLET_COUNT;
+    int iterations = 200000;
+    int fillPercent = 50;
+    int frames = 0;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fill") == 0 && i + 1 < argc)
+            fillPercent = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: SpaceInvaders --bench-ecs [--iterations N] [--fill PERCENT] [--frames N]\n");
+            return 1;
+        }
+    }
+    ResetGame();
+    SeedRandom(1);
+    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+    {
+        const int alien = SpawnEntity(alienArchetype);
+        alienPositions[alien] = (Vector2) { i, i };
+        referenceAliens[i].position = alienPositions[alien];
+        referenceAliens[i].alive = RandomValue(1, 100) <= fillPercent;
+    }
+    int playerBulletsLeft = MAX_PLAYER_BULLET_COUNT;
+    for (int i = 0; i < bulletCount; ++i)
+    {
+        referenceBullets[i].position = (Vector2) { i, i };
+        referenceBullets[i].belongsToPlayer = RandomValue(1, bulletCount - i) <= playerBulletsLeft;
+        referenceBullets[i].active = RandomValue(1, 100) <= fillPercent;
+        playerBulletsLeft -= referenceBullets[i].belongsToPlayer;
+        if (referenceBullets[i].belongsToPlayer)
+        {
+            const int bullet = SpawnEntity(playerBulletArchetype);
+            playerBulletPositions[bullet] = referenceBullets[i].position;
+            playerBulletVelocities[bullet] = (Vector2) { 0, -playerBulletSpeed };
+            playerBulletRadii[bullet] = playerBulletRadius;
+            playerBulletColors[bullet] = playerBulletColor;
+        }
+        else
+        {
+            const int bullet = SpawnEntity(alienBulletArchetype);
+            alienBulletPositions[bullet] = referenceBullets[i].position;
+            alienBulletVelocities[bullet] = (Vector2) { 0, alienBulletSpeed };
+            alienBulletRadii[bullet] = alienBulletRadius;
+            alienBulletColors[bullet] = alienBulletColor;
+        }
+    }
+    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+    {
+        if (!referenceAliens[i].alive)
+            DespawnEntity(alienArchetype, i);
+    }
+    int playerBullet = 0;
+    int alienBullet = 0;
+    for (int i = 0; i < bulletCount; ++i)
+    {
+        const int bullet = referenceBullets[i].belongsToPlayer ? playerBullet++ : alienBullet++;
+        if (!referenceBullets[i].active)
+            DespawnEntity(referenceBullets[i].belongsToPlayer ? playerBulletArchetype : alienBulletArchetype, bullet);
+    }
+    SteerFormationSystem();
+    double start = GetTimestamp();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+        {
+            if (referenceAliens[i].alive)
+            {
+                if (alienDirection == 0)
+                    referenceAliens[i].position.x += alienSpeed;
+                else
+                    referenceAliens[i].position.x -= alienSpeed;
+            }
+        }
+        for (int i = 0; i < bulletCount; ++i)
+        {
+            if (referenceBullets[i].active)
+            {
+                if (referenceBullets[i].belongsToPlayer)
+                    referenceBullets[i].position.y -= playerBulletSpeed;
+                else
+                    referenceBullets[i].position.y += alienBulletSpeed;
+            }
+        }
+    }
+    const double referenceSeconds = GetTimestamp() - start;
+    start = GetTimestamp();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        IntegrateSystem(alienArchetype);
+        IntegrateSystem(playerBulletArchetype);
+        IntegrateSystem(alienBulletArchetype);
+    }
+    const double systemSeconds = GetTimestamp() - start;
+    float referenceChecksum = 0;
+    float systemChecksum = 0;
+    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+    {
+        referenceChecksum += referenceAliens[i].position.x;
+        systemChecksum += alienPositions[i].x;
+    }
+    playerBullet = 0;
+    alienBullet = 0;
+    for (int i = 0; i < bulletCount; ++i)
+    {
+        referenceChecksum += referenceBullets[i].position.y;
+        systemChecksum += referenceBullets[i].belongsToPlayer ? playerBulletPositions[playerBullet++].y : alienBulletPositions[alienBullet++].y;
+    }
+    const int entityCount = MAX_ALIEN_COUNT + bulletCount;
+    printf("movement\n");
+    printf("  hand-written loops: %.2f ns/tick, %.3f ns/entity\n", referenceSeconds * 1e9 / iterations, referenceSeconds * 1e9 / iterations / entityCount);
+    printf("  archetype systems:  %.2f ns/tick, %.3f ns/entity\n", systemSeconds * 1e9 / iterations, systemSeconds * 1e9 / iterations / entityCount);
+    printf("  checksums %s (%.1f, %.1f)\n", referenceChecksum == systemChecksum ? "match" : "differ", referenceChecksum, systemChecksum);
+
+    for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+    {
+        referenceAliens[i].position = (Vector2) { i, i };
+        alienPositions[i] = referenceAliens[i].position;
+    }
+    playerBullet = 0;
+    alienBullet = 0;
+    for (int i = 0; i < bulletCount; ++i)
+    {
+        referenceBullets[i].position = (Vector2) { -screenWidth - i, i };
+        if (referenceBullets[i].belongsToPlayer)
+            playerBulletPositions[playerBullet++] = referenceBullets[i].position;
+        else
+            alienBulletPositions[alienBullet++] = referenceBullets[i].position;
+    }
+    const Vector2 playerCenter = { playerPositions[0].x + playerHalfWidth, playerPositions[0].y + playerHalfHeight };
+    int referenceHits = 0;
+    start = GetTimestamp();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        for (int i = 0; i < bulletCount; ++i)
+        {
+            if (!referenceBullets[i].active)
+                continue;
+            if (referenceBullets[i].belongsToPlayer)
+            {
+                for (int j = 0; j < MAX_ALIEN_COUNT; ++j)
+                {
+                    if (referenceAliens[j].alive && CheckCollisionCircles(referenceBullets[i].position, playerBulletRadius, (Vector2) { referenceAliens[j].position.x + alienHalfWidth, referenceAliens[j].position.y + alienHalfHeight }, alienHalfWidth))
+                    {
+                        ++referenceHits;
+                        break;
+                    }
+                }
+            }
+            else if (CheckCollisionCircles(referenceBullets[i].position, alienBulletRadius, playerCenter, playerHalfWidth))
+            {
+                ++referenceHits;
+            }
+        }
+    }
+    const double referenceCollisionSeconds = GetTimestamp() - start;
+    int systemHits = 0;
+    start = GetTimestamp();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        systemHits += UpdateCollisionSystem();
+    }
+    const double systemCollisionSeconds = GetTimestamp() - start;
+    printf("collision\n");
+    printf("  hand-written loops: %.2f ns/tick, %.3f ns/entity\n", referenceCollisionSeconds * 1e9 / iterations, referenceCollisionSeconds * 1e9 / iterations / entityCount);
+    printf("  archetype systems:  %.2f ns/tick, %.3f ns/entity\n", systemCollisionSeconds * 1e9 / iterations, systemCollisionSeconds * 1e9 / iterations / entityCount);
+    printf("  hits %s (%d, %d)\n", referenceHits == systemHits ? "match" : "differ", referenceHits, systemHits);
+    if (frames <= 0)
+        return 0;
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(screenWidth, screenHeight, "Space Invaders");
+    playerTexture = LoadTexture("Player.png");
+    alienTexture = LoadTexture("Alien.png");
+    const Rectangle alienSource = { 0, 0, alienTexture.width / 2, alienTexture.height };
+    start = GetTimestamp();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        BeginDrawing();
+        ClearBackground(BLACK);
+        DrawTextureV(playerTexture, playerPositions[0], WHITE);
+        for (int i = 0; i < MAX_ALIEN_COUNT; ++i)
+        {
+            if (referenceAliens[i].alive)
+                DrawTextureRec(alienTexture, alienSource, referenceAliens[i].position, WHITE);
+        }
+        for (int i = 0; i < bulletCount; ++i)
+        {
+            if (!referenceBullets[i].active)
+                continue;
+            if (referenceBullets[i].belongsToPlayer)
+                DrawCircleV(referenceBullets[i].position, playerBulletRadius, playerBulletColor);
+            else
+                DrawCircleV(referenceBullets[i].position, alienBulletRadius, alienBulletColor);
+        }
+        EndDrawing();
+    }
+    const double referenceDrawSeconds = GetTimestamp() - start;
+    start = GetTimestamp();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        BeginDrawing();
+        ClearBackground(BLACK);
+        DrawSpriteSystem();
+        DrawCircleSystem();
+        EndDrawing();
+    }
+    const double systemDrawSeconds = GetTimestamp() - start;
+    UnloadTexture(playerTexture);
+    UnloadTexture(alienTexture);
+    CloseWindow();
+    printf("draw\n");
+    printf("  hand-written loops: %.2f ns/frame, %.3f ns/entity\n", referenceDrawSeconds * 1e9 / frames, referenceDrawSeconds * 1e9 / frames / entityCount);
+    printf("  archetype systems:  %.2f ns/frame, %.3f ns/entity\n", systemDrawSeconds * 1e9 / frames, systemDrawSeconds * 1e9 / frames / entityCount);
+    return 0;
+}
+
+int RunAttractRecorder(int argc, char *argv[])
 {
-    bullets[nextAvailableBullet].position = (Vector2) { aliens[alienIndex].position.x + alienHalfWidth, aliens[alienIndex].position.y + alienWidth + alienBulletRadius };
-    bullets[nextAvailableBullet].belongsToPlayer = false;
-    bullets[nextAvailableBullet].active = true;
-    ++nextAvailableBullet;
-    nextAvailableBullet %= MAX_BULLET_COUNT;
-    PlaySound(shootSound);
-}
\ No newline at end of file
+    ScriptedPlayer profile = { 6, 12, 0, 24, 0, 0, 0 };
+    unsigned int seed = 1;
+    int startWave = 1;
+    int maxTicks = attractMaxTicks;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--wave") == 0 && i + 1 < argc)
+            startWave = Clamp(atoi(argv[++i]), 1, MAX_BALANCE_WAVE_COUNT);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            maxTicks = SecondsToTicks(atof(argv[++i]));
+        else
+        {
+            fprintf(stderr, "usage: SpaceInvaders --record-attract [--seed N] [--wave N] [--seconds S]\n");
+            return 1;
+        }
+    }
+    BuildUfoPaths();
+    BuildBulletPatterns();
+    ResetGame();
+    SeedRandom(seed);
+    wave = startWave;
+    ChangeGameState(readyState);
+    profile.targetX = playerPositions[0].x + playerHalfWidth;
+    unsigned short run = 0;
+    int runCount = 0;
+    printf("static const unsigned short attractDemoRuns[] = {");
+    for (int tick = 0; tick < maxTicks && gameState != startState; ++tick)
+    {
+        const unsigned int state = randomState;
+        input = gameState == playState ? UpdateScriptedPlayer(&profile) : 0;
+        randomState = state;
+        if (run != 0 && (unsigned int)(run >> REPLAY_RUN_LENGTH_BITS) == input && (run & replayMaxRunLength) < replayMaxRunLength)
+        {
+            ++run;
+        }
+        else
+        {
+            if (run != 0)
+                printf("%s0x%04X,", runCount++ % 12 == 0 ? "\n    " : " ", run);
+            run = (input << REPLAY_RUN_LENGTH_BITS) | 1;
+        }
+        frameTime = tickTime;
+        UpdateSimulation();
+    }
+    printf("%s0x%04X\n};\n", runCount++ % 12 == 0 ? "\n    " : " ", run);
+    printf("// seed %u, wave %d, %d runs, wave reached %d, score %d\n", seed, startWave, runCount, wave, score);
+    return 0;
+}
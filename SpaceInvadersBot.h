@@ -0,0 +1,108 @@
+//////////////////////////////////////////////////////////////////////
+// LICENSE
+//////////////////////////////////////////////////////////////////////
+
+// MIT License
+
+// Copyright (c) 2021 Klayton Kowalski
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// https://github.com/klaytonkowalski/game-space-invaders
+
+// Bot controller plugin interface. A plugin is a shared library exporting
+// SpaceInvadersBotAbiVersion and SpaceInvadersBotUpdate (and optionally
+// SpaceInvadersBotShutdown). The view and everything it points to is owned by
+// the game and only valid for the duration of the call.
+
+#ifndef SPACE_INVADERS_BOT_H
+#define SPACE_INVADERS_BOT_H
+
+//////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////
+// DEFINES
+//////////////////////////////////////////////////////////////////////
+
+#define SPACE_INVADERS_BOT_ABI_VERSION 2
+
+#define SPACE_INVADERS_BOT_LEFT 1
+#define SPACE_INVADERS_BOT_RIGHT 2
+#define SPACE_INVADERS_BOT_SHOOT 4
+#define SPACE_INVADERS_BOT_SHOOT_HELD 8
+
+#define SPACE_INVADERS_BOT_PLAY_STATE 2
+
+#if defined(_WIN32)
+#define SPACE_INVADERS_BOT_EXPORT __declspec(dllexport)
+#else
+#define SPACE_INVADERS_BOT_EXPORT __attribute__((visibility("default")))
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// STRUCTURES
+//////////////////////////////////////////////////////////////////////
+
+typedef struct SpaceInvadersBotVector
+{
+    float x;
+    float y;
+}
+SpaceInvadersBotVector;
+
+typedef struct SpaceInvadersBotView
+{
+    uint32_t abiVersion;
+    uint32_t tick;
+    uint32_t gameState;
+    uint32_t wave;
+    uint32_t score;
+    uint32_t livesRemaining;
+    SpaceInvadersBotVector boundsPosition;
+    SpaceInvadersBotVector boundsSize;
+    float playerSpeed;
+    uint8_t playerAlive;
+    SpaceInvadersBotVector playerPosition;
+    SpaceInvadersBotVector playerSize;
+    SpaceInvadersBotVector alienSize;
+    uint32_t alienExtent;
+    const uint8_t *alienAlive;
+    const SpaceInvadersBotVector *alienPositions;
+    uint32_t playerBulletExtent;
+    const uint8_t *playerBulletAlive;
+    const SpaceInvadersBotVector *playerBulletPositions;
+    const SpaceInvadersBotVector *playerBulletVelocities;
+    const float *playerBulletRadii;
+    uint32_t alienBulletExtent;
+    const uint8_t *alienBulletAlive;
+    const SpaceInvadersBotVector *alienBulletPositions;
+    const SpaceInvadersBotVector *alienBulletVelocities;
+    const float *alienBulletRadii;
+}
+SpaceInvadersBotView;
+
+typedef uint32_t (*SpaceInvadersBotAbiVersionFunction)(void);
+typedef uint32_t (*SpaceInvadersBotUpdateFunction)(const SpaceInvadersBotView *view);
+typedef void (*SpaceInvadersBotShutdownFunction)(void);
+
+#endif